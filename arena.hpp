@@ -0,0 +1,30 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+
+// Memory for one session: its world state, inventory and game coroutine all come from here, and
+// nothing is given back until the session is over, when the whole arena goes at once. The first
+// few kilobytes are inline, which is all the built-in world's sessions ever use, so a session
+// allocates nothing from the heap beyond where the arena itself lives and thousands of them can
+// run side by side without meeting in the allocator. Bigger worlds spill over into blocks taken
+// from the heap, which are freed along with the rest.
+//
+// An arena belongs to one session, and so to one thread at a time; it does no locking.
+class SessionArena {
+public:
+    static constexpr size_t INLINE_BYTES = 4096;
+
+    SessionArena() = default;
+
+    SessionArena(const SessionArena &) = delete;
+    SessionArena &operator=(const SessionArena &) = delete;
+
+    std::pmr::memory_resource *memory() { return &resource; }
+
+private:
+    alignas(std::max_align_t) std::array<std::byte, INLINE_BYTES> storage;
+    std::pmr::monotonic_buffer_resource resource{storage.data(), storage.size(),
+                                                 std::pmr::new_delete_resource()};
+};
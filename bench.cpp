@@ -0,0 +1,263 @@
+#include "dungeon.hpp"
+#include "game.hpp"
+#include "script.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Microbenchmarks for the engine's hot paths: building the world, starting a session, parsing
+// commands, moving, unlocking chests, giving items and a whole winning playthrough. Results go
+// out as JSON, one benchmark to a line, so runs from two commits can be kept and compared:
+//   ./bench --json before.json
+//   ./bench --baseline before.json
+//
+// Each benchmark is run for a doubling number of iterations until one run takes long enough to
+// time, then timed SAMPLES times over; the median is reported along with the fastest and slowest.
+
+constexpr int SAMPLES = 5;
+
+// Keeps the compiler from dropping work whose result the benchmark never looks at
+template <typename T> void keep(const T &value) { asm volatile("" : : "r"(&value) : "memory"); }
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations;
+    double ns_per_op;
+    double min_ns_per_op;
+    double max_ns_per_op;
+};
+
+class BenchRunner {
+public:
+    BenchRunner(std::string filter, std::chrono::nanoseconds min_time)
+        : filter(std::move(filter)), min_time(min_time) {}
+
+    // `body(n)` performs the operation n times; setup done outside it is not timed
+    template <typename Body> void run(const std::string &name, Body &&body) {
+        if (name.find(filter) == std::string::npos) return;
+        uint64_t iterations = 1;
+        while (time(body, iterations) < min_time / SAMPLES && iterations < (uint64_t{1} << 40)) {
+            iterations *= 2;
+        }
+        std::vector<double> samples;
+        for (int i = 0; i < SAMPLES; i++) {
+            samples.push_back(static_cast<double>(time(body, iterations).count()) / iterations);
+        }
+        std::sort(samples.begin(), samples.end());
+        results.push_back(
+            BenchResult{name, iterations, samples[SAMPLES / 2], samples.front(), samples.back()});
+        std::cerr << std::left << std::setw(24) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << samples[SAMPLES / 2] << " ns/op\n";
+    }
+
+    void write_json(std::ostream &out) const {
+        out << "{\n  \"suite\": \"tenebrae\",\n  \"compiler\": \"" << __VERSION__
+            << "\",\n  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n"
+            << std::fixed << std::setprecision(1);
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult &r = results[i];
+            out << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+                << ", \"ns_per_op\": " << r.ns_per_op << ", \"min_ns_per_op\": "
+                << r.min_ns_per_op << ", \"max_ns_per_op\": " << r.max_ns_per_op << "}"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+    }
+
+    // Compares against an earlier run's JSON; only reads what write_json writes
+    bool compare(const std::string &path) const {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "Could not open baseline " << path << "\n";
+            return false;
+        }
+        std::map<std::string, double> baseline;
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t name = line.find("\"name\": \""), ns = line.find("\"ns_per_op\": ");
+            if (name == std::string::npos || ns == std::string::npos) continue;
+            name += 9;
+            baseline[line.substr(name, line.find('"', name) - name)] =
+                std::strtod(line.c_str() + ns + 13, nullptr);
+        }
+        std::cerr << "\n" << std::left << std::setw(24) << "Benchmark" << std::right
+                  << std::setw(12) << "Before" << std::setw(12) << "After" << std::setw(10)
+                  << "Change\n";
+        for (const BenchResult &r : results) {
+            auto before = baseline.find(r.name);
+            if (before == baseline.end() || before->second <= 0) continue;
+            std::cerr << std::left << std::setw(24) << r.name << std::right << std::fixed
+                      << std::setprecision(1) << std::setw(12) << before->second
+                      << std::setw(12) << r.ns_per_op << std::setw(9) << std::showpos
+                      << (r.ns_per_op / before->second - 1) * 100 << std::noshowpos << "%\n";
+        }
+        return true;
+    }
+
+private:
+    std::string filter;
+    std::chrono::nanoseconds min_time;
+    std::vector<BenchResult> results;
+
+    template <typename Body> static std::chrono::nanoseconds time(Body &body, uint64_t n) {
+        auto start = std::chrono::steady_clock::now();
+        body(n);
+        return std::chrono::steady_clock::now() - start;
+    }
+};
+
+void run_benchmarks(BenchRunner &bench, const WorldTemplate &world, const std::string &script) {
+    bench.run("world/builtin", [](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            WorldTemplate built = builtin_world();
+            keep(built);
+        }
+    });
+
+    // What start_new_game does before the first command
+    bench.run("session/start", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            SessionArena arena;
+            Session session(world, arena.memory());
+            Output out(arena.memory());
+            LineTask<GameResult> game = play_session(session, out);
+            keep(out);
+        }
+    });
+
+    const std::vector<std::string> lines = {
+        "search", "take", "open", "go north", "inventory", "talk to the priest",
+        "give blood bottle to the mother", "attack guard", "giv blod bottle", "xyzzy"};
+    bench.run("command/parse", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            Command command = parse_command(lines[i % lines.size()]);
+            keep(command);
+        }
+    });
+
+    const std::vector<std::string> moves = {"north", "s", "go east", "walk west", "noth", "up"};
+    bench.run("command/direction", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            Command command = parse_command(moves[i % moves.size()]);
+            keep(command.direction);
+        }
+    });
+
+    // Back and forth between the first two rooms of the walkthrough
+    bench.run("move/attempt_move", [&](uint64_t n) {
+        SessionArena arena;
+        Session session(world, arena.memory());
+        Output out(arena.memory());
+        for (uint64_t i = 0; i < n; i++) {
+            attempt_move(session, i % 2 ? Direction::North : Direction::South, out);
+            out.clear();
+        }
+    });
+
+    // The chest with the most keys, opened by a player carrying everything there is
+    auto chests = world.chests();
+    auto most_keys = std::max_element(chests.begin(), chests.end(), [](auto &a, auto &b) {
+        return a.key_count < b.key_count;
+    });
+    if (most_keys != chests.end()) {
+        uint32_t chest = static_cast<uint32_t>(most_keys - chests.begin());
+        bench.run("chest/can_unlock_" + std::to_string(most_keys->key_count) + "_keys",
+                  [&](uint64_t n) {
+                      Session session(world);
+                      for (ItemId item = 0; item < world.items().size(); item++) {
+                          session.player.player_inventory.push_back(item);
+                      }
+                      for (uint64_t i = 0; i < n; i++) keep(session.can_unlock_chest(chest));
+                  });
+    }
+
+    // Each gift is made from the same state, which is put back first
+    auto npcs = world.npcs();
+    auto wanting = std::find_if(npcs.begin(), npcs.end(),
+                                [](const NpcRecord &npc) { return npc.required_item != NO_ITEM; });
+    if (wanting != npcs.end()) {
+        bench.run("npc/give_item", [&](uint64_t n) {
+            SessionArena arena;
+            Session session(world, arena.memory());
+            Output out(arena.memory());
+            session.room_current = wanting->room;
+            const WorldState fresh = session.state;
+            std::string item(world.item_name(wanting->required_item));
+            std::string npc(world.lowercase_npc_name(wanting->name_id));
+            for (uint64_t i = 0; i < n; i++) {
+                session.state = fresh;
+                session.player.player_inventory.assign(1, wanting->required_item);
+                give_item_to_npc(session, item, npc, out);
+                out.clear();
+            }
+        });
+    }
+
+    NullBuffer null_buffer;
+    std::ostream sink(&null_buffer);
+    {
+        std::istringstream in(script);
+        if (start_new_game(world, in, sink) != GameResult::Won) {
+            throw std::runtime_error("the walkthrough script does not win the game");
+        }
+    }
+    bench.run("game/walkthrough", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            std::istringstream in(script);
+            keep(start_new_game(world, in, sink));
+        }
+    });
+}
+
+int main(int argc, char **argv) {
+    std::string filter, script_path = "scripts/walkthrough.txt", json_path, baseline_path;
+    long min_time_ms = 500;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--filter" && has_value) {
+            filter = argv[++i];
+        } else if (arg == "--script" && has_value) {
+            script_path = argv[++i];
+        } else if (arg == "--json" && has_value) {
+            json_path = argv[++i];
+        } else if (arg == "--baseline" && has_value) {
+            baseline_path = argv[++i];
+        } else if (arg == "--min-time" && has_value) {
+            min_time_ms = std::strtol(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--filter <text>] [--script <file>] [--min-time <ms>]\n"
+                      << "       [--json <file>] [--baseline <file>]\n";
+            return 1;
+        }
+    }
+
+    try {
+        BenchRunner bench(filter, std::chrono::milliseconds(std::max(min_time_ms, 1L)));
+        WorldTemplate world = builtin_world();
+        std::vector<Script> scripts;
+        if (!load_script(script_path, scripts)) return 1;
+        run_benchmarks(bench, world, scripts.front().commands);
+
+        if (json_path.empty()) {
+            bench.write_json(std::cout);
+        } else {
+            std::ofstream out(json_path);
+            bench.write_json(out);
+            if (!out) throw std::runtime_error("could not write " + json_path);
+        }
+        if (!baseline_path.empty() && !bench.compare(baseline_path)) return 1;
+    } catch (const std::exception &e) {
+        std::cerr << "bench: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
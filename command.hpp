@@ -0,0 +1,303 @@
+#pragma once
+
+#include "world.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Verbs the game loop dispatches on
+enum class Verb {
+    Search,
+    Take,
+    Inventory,
+    Open,
+    Move,
+    Talk,
+    Give,
+    KillSelf,
+    Attack,
+    Drink,
+    Save,
+    Load,
+    Language,
+    Stats,
+    Quit,
+    Unknown
+};
+
+constexpr size_t VERB_COUNT = static_cast<size_t>(Verb::Unknown) + 1;
+
+const char *const VERB_NAMES[VERB_COUNT] = {"search",   "take",  "inventory", "open",
+                                            "move",     "talk",  "give",      "kill self",
+                                            "attack",   "drink", "save",      "load",
+                                            "language", "stats", "quit",      "unknown"};
+
+// One line of player input, already lowercased. The views point into that line.
+struct Command {
+    Verb verb = Verb::Unknown;
+    Direction direction = Direction::North; // for Verb::Move
+    std::string_view object; // item or NPC the verb acts on, a save code or a language
+    std::string_view target; // NPC named after "to" in "give <item> to <npc>"
+    std::string_view suggestion; // for Verb::Unknown, a keyword too drastic to run on a guess
+};
+
+// Words that can start a command, or follow "go"
+enum class Keyword : uint8_t {
+    None,
+    Search,
+    Take,
+    Inventory,
+    Open,
+    Use,
+    Direction,
+    Go,
+    Talk,
+    Give,
+    Kill,
+    Suicide,
+    Attack,
+    Drink,
+    Save,
+    Load,
+    Language,
+    Stats,
+    Quit
+};
+
+struct KeywordEntry {
+    std::string_view word;
+    Keyword keyword;
+};
+
+constexpr KeywordEntry KEYWORDS[] = {
+    {"search", Keyword::Search},   {"find", Keyword::Search},     {"look", Keyword::Search},
+    {"take", Keyword::Take},       {"inventory", Keyword::Inventory},
+    {"open", Keyword::Open},       {"use", Keyword::Use},         {"north", Keyword::Direction},
+    {"south", Keyword::Direction}, {"east", Keyword::Direction},  {"west", Keyword::Direction},
+    {"go", Keyword::Go},           {"walk", Keyword::Go},         {"move", Keyword::Go},
+    {"talk", Keyword::Talk},       {"ask", Keyword::Talk},        {"give", Keyword::Give},
+    {"kill", Keyword::Kill},       {"suicide", Keyword::Suicide}, {"attack", Keyword::Attack},
+    {"drink", Keyword::Drink},     {"save", Keyword::Save},       {"load", Keyword::Load},
+    {"restore", Keyword::Load},    {"language", Keyword::Language},
+    {"stats", Keyword::Stats},     {"quit", Keyword::Quit},       {"exit", Keyword::Quit},
+};
+
+// Keywords are found through a perfect hash: the top bits of a seeded FNV-1a hash index a
+// 64-slot table, and the seed is searched at compile time so that no two keywords collide
+constexpr size_t KEYWORD_SLOTS = 64;
+
+constexpr size_t keyword_hash(std::string_view word, uint32_t seed) {
+    uint32_t h = seed;
+    for (char c : word) {
+        h = (h ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return h >> 26;
+}
+
+constexpr bool keyword_seed_is_perfect(uint32_t seed) {
+    std::array<bool, KEYWORD_SLOTS> used{};
+    for (const auto &entry : KEYWORDS) {
+        size_t slot = keyword_hash(entry.word, seed);
+        if (used[slot]) return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t find_keyword_seed() {
+    uint32_t seed = 1;
+    while (!keyword_seed_is_perfect(seed)) seed++;
+    return seed;
+}
+
+constexpr uint32_t KEYWORD_SEED = find_keyword_seed();
+
+constexpr std::array<uint8_t, KEYWORD_SLOTS> build_keyword_table() {
+    std::array<uint8_t, KEYWORD_SLOTS> slots{}; // index into KEYWORDS plus one, 0 if empty
+    for (size_t i = 0; i < std::size(KEYWORDS); i++) {
+        slots[keyword_hash(KEYWORDS[i].word, KEYWORD_SEED)] = static_cast<uint8_t>(i + 1);
+    }
+    return slots;
+}
+
+constexpr std::array<uint8_t, KEYWORD_SLOTS> KEYWORD_TABLE = build_keyword_table();
+
+constexpr Keyword find_keyword(std::string_view word) {
+    uint8_t slot = KEYWORD_TABLE[keyword_hash(word, KEYWORD_SEED)];
+    if (slot != 0 && KEYWORDS[slot - 1].word == word) return KEYWORDS[slot - 1].keyword;
+    return Keyword::None;
+}
+
+// Keywords for what cannot be taken back: dying, fighting, losing or replacing the game. A typo
+// that comes close to one is not run; the player is asked if they meant it.
+constexpr bool keyword_is_drastic(Keyword keyword) {
+    switch (keyword) {
+    case Keyword::Kill:
+    case Keyword::Suicide:
+    case Keyword::Attack:
+    case Keyword::Drink:
+    case Keyword::Save:
+    case Keyword::Load:
+    case Keyword::Quit:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// The keyword a mistyped word was meant to be ("noth", "giv"), or an empty view
+inline std::string_view closest_keyword(std::string_view word) {
+    ClosestMatch match(word);
+    for (uint32_t i = 0; i < std::size(KEYWORDS); i++) match.consider(KEYWORDS[i].word, i);
+    return match.matched() ? KEYWORDS[match.id(0)].word : std::string_view{};
+}
+
+static_assert(find_keyword("inventory") == Keyword::Inventory);
+static_assert(find_keyword("exit") == Keyword::Quit);
+static_assert(find_keyword("dance") == Keyword::None);
+
+// Splits a line into words without copying it
+class Tokenizer {
+public:
+    explicit Tokenizer(std::string_view line) : line(line) {}
+
+    std::string_view next() {
+        while (pos < line.size() && is_space(line[pos])) pos++;
+        size_t start = pos;
+        while (pos < line.size() && !is_space(line[pos])) pos++;
+        return line.substr(start, pos - start);
+    }
+
+    // Everything after the current word, without surrounding whitespace
+    std::string_view rest() const {
+        size_t start = pos;
+        while (start < line.size() && is_space(line[start])) start++;
+        size_t end = line.size();
+        while (end > start && is_space(line[end - 1])) end--;
+        return line.substr(start, end - start);
+    }
+
+private:
+    std::string_view line;
+    size_t pos = 0;
+
+    static constexpr bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+    }
+};
+
+// A direction, allowing for a typo
+inline std::optional<Direction> find_direction_near(std::string_view word) {
+    if (std::optional<Direction> direction = find_direction(word)) return direction;
+    ClosestMatch match(word);
+    for (uint32_t i = 0; i < DIRECTION_COUNT; i++) match.consider(DIRECTION_NAMES[i], i);
+    if (!match.matched()) return std::nullopt;
+    return static_cast<Direction>(match.id(0));
+}
+
+// Drops a leading word such as "to" or "the" from a phrase
+inline std::string_view skip_word(std::string_view phrase, std::string_view word) {
+    if (phrase.size() > word.size() && phrase.substr(0, word.size()) == word &&
+        phrase[word.size()] == ' ') {
+        return phrase.substr(word.size() + 1);
+    }
+    return phrase == word ? std::string_view{} : phrase;
+}
+
+// Classifies a line in one pass over its first words and binds the rest as the object
+inline Command parse_command(std::string_view line) {
+    Tokenizer tokens(line);
+    std::string_view word = tokens.next();
+    Command command;
+
+    Keyword keyword = find_keyword(word);
+    if (keyword == Keyword::None) {
+        word = closest_keyword(word);
+        keyword = find_keyword(word);
+        if (keyword_is_drastic(keyword)) {
+            command.suggestion = word;
+            return command;
+        }
+    }
+    switch (keyword) {
+    case Keyword::Search:
+        command.verb = Verb::Search;
+        break;
+    case Keyword::Take:
+        command.verb = Verb::Take;
+        break;
+    case Keyword::Inventory:
+        command.verb = Verb::Inventory;
+        break;
+    case Keyword::Open:
+        command.verb = Verb::Open;
+        break;
+    case Keyword::Use:
+        if (tokens.rest() == "key") command.verb = Verb::Open;
+        break;
+    case Keyword::Direction:
+        command.verb = Verb::Move;
+        command.direction = *find_direction(word);
+        break;
+    case Keyword::Go:
+        if (std::optional<Direction> direction = find_direction_near(tokens.next())) {
+            command.verb = Verb::Move;
+            command.direction = *direction;
+        }
+        break;
+    case Keyword::Talk:
+        command.verb = Verb::Talk;
+        command.object = skip_word(tokens.rest(), "to");
+        break;
+    case Keyword::Give: {
+        command.verb = Verb::Give;
+        std::string_view rest = tokens.rest();
+        size_t to = rest.find(" to ");
+        command.object = rest.substr(0, to);
+        if (to != std::string_view::npos) command.target = rest.substr(to + 4);
+        break;
+    }
+    case Keyword::Kill: {
+        std::string_view rest = tokens.rest();
+        if (rest == "self" || rest == "myself") {
+            command.verb = Verb::KillSelf;
+        } else {
+            command.verb = Verb::Attack;
+            command.object = rest;
+        }
+        break;
+    }
+    case Keyword::Suicide:
+        command.verb = Verb::KillSelf;
+        break;
+    case Keyword::Attack:
+        command.verb = Verb::Attack;
+        command.object = tokens.rest();
+        break;
+    case Keyword::Drink:
+        command.verb = Verb::Drink;
+        command.object = tokens.rest();
+        break;
+    case Keyword::Save:
+        command.verb = Verb::Save;
+        break;
+    case Keyword::Load:
+        command.verb = Verb::Load;
+        command.object = tokens.rest();
+        break;
+    case Keyword::Language:
+        command.verb = Verb::Language;
+        command.object = tokens.rest();
+        break;
+    case Keyword::Stats:
+        command.verb = Verb::Stats;
+        break;
+    case Keyword::Quit:
+        command.verb = Verb::Quit;
+        break;
+    case Keyword::None:
+        break;
+    }
+    return command;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "output.hpp"
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <utility>
+
+// A conversation written as a C++20 coroutine: it writes to an Output, suspends at
+// `co_await next_line` until its driver has a line of input for it, and `co_return`s how it
+// ended. Suspended, it is just its frame, so one thread can hold any number of them and resume
+// whichever has input; what drives it (a blocking stream, a socket, a script) is up to the
+// caller.
+//
+// Each resumption hands the coroutine the Output to answer in along with the line, since the
+// driver may keep output somewhere different from one line to the next.
+//
+// A coroutine whose first parameter has memory() of its own, as a Session does, keeps its frame
+// there, so it goes with the rest of the session; any other gets it from the heap.
+
+struct Turn {
+    std::string &line;
+    Output &out;
+};
+
+struct NextLine {};
+inline constexpr NextLine next_line{};
+
+template <typename Result> class LineTask {
+public:
+    struct promise_type {
+        std::optional<Result> result;
+        std::exception_ptr error;
+        std::string *line = nullptr;
+        Output *out = nullptr;
+
+        template <typename Owner, typename... Rest>
+            requires requires(Owner &owner) {
+                { owner.memory() } -> std::convertible_to<std::pmr::memory_resource *>;
+            }
+        static void *operator new(size_t size, Owner &owner, Rest &...) {
+            return allocate(size, owner.memory());
+        }
+
+        static void *operator new(size_t size) {
+            return allocate(size, std::pmr::new_delete_resource());
+        }
+
+        static void operator delete(void *frame, size_t size) noexcept {
+            std::byte *block = static_cast<std::byte *>(frame) - HEADER;
+            auto *memory = *reinterpret_cast<std::pmr::memory_resource **>(block);
+            memory->deallocate(block, size + HEADER, HEADER);
+        }
+
+        LineTask get_return_object() {
+            return LineTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        // Runs until it first needs input, so the greeting is written as soon as it is created
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        void return_value(Result value) { result = std::move(value); }
+        void unhandled_exception() { error = std::current_exception(); }
+
+        auto await_transform(NextLine) {
+            struct Awaiter {
+                promise_type &promise;
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<>) const noexcept {}
+                Turn await_resume() const noexcept { return Turn{*promise.line, *promise.out}; }
+            };
+            return Awaiter{*this};
+        }
+
+    private:
+        // The frame is preceded by where it came from, for operator delete to give it back to
+        static constexpr size_t HEADER = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+        static void *allocate(size_t size, std::pmr::memory_resource *memory) {
+            auto *block = static_cast<std::byte *>(memory->allocate(size + HEADER, HEADER));
+            *reinterpret_cast<std::pmr::memory_resource **>(block) = memory;
+            return block + HEADER;
+        }
+    };
+
+    LineTask(LineTask &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    LineTask &operator=(LineTask &&other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    ~LineTask() {
+        if (handle) handle.destroy();
+    }
+
+    bool done() const { return handle.done(); }
+
+    // How it ended; only once done()
+    const Result &result() const {
+        rethrow();
+        return *handle.promise().result;
+    }
+
+    // Runs the coroutine on one line until it wants the next or ends. The line may be changed.
+    void send(std::string &line, Output &out) {
+        promise_type &promise = handle.promise();
+        promise.line = &line;
+        promise.out = &out;
+        handle.resume();
+        rethrow();
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit LineTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    void rethrow() const {
+        if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+    }
+};
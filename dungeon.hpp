@@ -0,0 +1,525 @@
+#pragma once
+
+#include "descriptions.hpp"
+#include "world_builder.hpp"
+
+// The built-in Tenebrae dungeon. It is compiled into a world image in memory at startup; a
+// world file passed with --world replaces it.
+
+// The item registry. Items are defined in this order, which fixes their ItemIds; save records
+// store those ids, so new items go at the end. Sessions only ever hold ItemIds into the compiled
+// world, whose item table is read-only and shared by every thread.
+struct ItemDefinition {
+    std::string_view name;
+    std::string_view description;
+};
+
+inline const ItemDefinition BUILTIN_ITEMS[] = {
+    {"ORBIS DEI", descriptions::ITEM_ORBIS_DEI},
+    {"blood bottle", descriptions::ITEM_BLOOD_BOTTLE},
+    {"blood necklace", descriptions::ITEM_BLOOD_NECKLACE},
+    {"blood-stained key", descriptions::ITEM_BLOODSTAINED_KEY},
+    {"cell key", descriptions::ITEM_CELL_KEY},
+    {"filius orbis", descriptions::ITEM_FILIUS_ORBIS},
+    {"gold key", descriptions::ITEM_GOLD_KEY},
+    {"mater orbis", descriptions::ITEM_MATER_ORBIS},
+    {"mother's heart", descriptions::ITEM_MOTHERS_HEART},
+    {"notes", descriptions::ITEM_NOTES},
+    {"obsidian dagger", descriptions::ITEM_OBSIDIAN_DAGGER},
+    {"pater orbis", descriptions::ITEM_PATER_ORBIS},
+    {"room key", descriptions::ITEM_ROOM_KEY},
+    {"rusted knife", descriptions::ITEM_RUSTED_KNIFE},
+    {"torn note", descriptions::ITEM_TORN_NOTE},
+    {"wooden sword", descriptions::ITEM_WOODEN_SWORD}};
+
+inline void build_world(WorldBuilder &world) {
+    for (const ItemDefinition &item : BUILTIN_ITEMS) {
+        world.define_item(std::string(item.name), item.description);
+    }
+
+    RoomId room_start = world.add_room("start", descriptions::ROOM_START,
+                                       descriptions::SEARCH_START);
+    RoomId room_start_north = world.add_room("start_north", descriptions::ROOM_START_NORTH);
+    RoomId room_start_south = world.add_room("start_south", descriptions::ROOM_START_SOUTH,
+                                             descriptions::SEARCH_SOUTH);
+    RoomId room_start_east = world.add_room("start_east", descriptions::ROOM_START_EAST,
+                                            descriptions::SEARCH_EAST);
+    RoomId room_start_west = world.add_room("start_west", descriptions::ROOM_START_WEST);
+    RoomId room_start_northeast = world.add_room("start_northeast",
+                                                 descriptions::ROOM_START_NORTHEAST);
+    RoomId room_start_northwest = world.add_room("start_northwest",
+                                                 descriptions::ROOM_START_NORTHWEST);
+    RoomId room_start_southeast = world.add_room("start_southeast",
+                                                 descriptions::ROOM_START_SOUTHEAST);
+    RoomId room_start_southwest = world.add_room("start_southwest",
+                                                 descriptions::ROOM_START_SOUTHWEST);
+    RoomId room_prison_hallway_1 = world.add_room("prison_hallway_1",
+                                                  descriptions::ROOM_PRISON_HALLWAY_1);
+    RoomId room_prison_hallway_2 = world.add_room("prison_hallway_2",
+                                                  descriptions::ROOM_PRISON_HALLWAY_2);
+    RoomId room_prison_hallway_3 = world.add_room("prison_hallway_3",
+                                                  descriptions::ROOM_PRISON_HALLWAY_3);
+    RoomId room_prison_hallway_4 = world.add_room("prison_hallway_4",
+                                                  descriptions::ROOM_PRISON_HALLWAY_4,
+                                                  descriptions::SEARCH_PRISON_HALLWAY_4);
+    RoomId room_prison_hallway_5 = world.add_room("prison_hallway_5",
+                                                  descriptions::ROOM_PRISON_HALLWAY_5,
+                                                  descriptions::SEARCH_PRISON_HALLWAY_5);
+    RoomId room_prison_hallway_7 = world.add_room("prison_hallway_7",
+                                                  descriptions::ROOM_PRISON_HALLWAY_7);
+    RoomId room_prison_1_middle = world.add_room("prison_1_middle",
+                                                 descriptions::ROOM_PRISON_1_MIDDLE,
+                                                 descriptions::SEARCH_ROOM_PRISON_1_MIDDLE);
+    RoomId room_prison_1_north = world.add_room("prison_1_north",
+                                                descriptions::ROOM_PRISON_1_NORTH);
+    RoomId room_prison_1_south = world.add_room("prison_1_south",
+                                                descriptions::ROOM_PRISON_1_SOUTH);
+    RoomId room_prison_1_east = world.add_room("prison_1_east", descriptions::ROOM_PRISON_1_EAST);
+    RoomId room_prison_1_west = world.add_room("prison_1_west", descriptions::ROOM_PRISON_1_WEST,
+                                               descriptions::SEARCH_ROOM_PRISON_1_WEST);
+    RoomId room_prison_1_northeast = world.add_room("prison_1_northeast",
+                                                    descriptions::ROOM_PRISON_1_NORTHEAST);
+    RoomId room_prison_1_northwest = world.add_room("prison_1_northwest",
+                                                    descriptions::ROOM_PRISON_1_NORTHWEST);
+    RoomId room_prison_1_southeast = world.add_room("prison_1_southeast",
+                                                    descriptions::ROOM_PRISON_1_SOUTHEAST,
+                                                    descriptions::SEARCH_ROOM_PRISON_1_SOUTHEAST);
+    RoomId room_prison_1_southwest = world.add_room("prison_1_southwest",
+                                                    descriptions::ROOM_PRISON_1_SOUTHWEST);
+    RoomId room_prison_hallway_8 = world.add_room("prison_hallway_8",
+                                                  descriptions::ROOM_PRISON_HALLWAY_8);
+    RoomId room_prison_hallway_6 = world.add_room("prison_hallway_6",
+                                                  descriptions::ROOM_PRISON_HALLWAY_6);
+    RoomId room_prison_2_southeast = world.add_room("prison_2_southeast",
+                                                    descriptions::ROOM_PRISON_2_SOUTHEAST);
+    RoomId room_prison_2_south = world.add_room("prison_2_south",
+                                                descriptions::ROOM_PRISON_2_SOUTH);
+    RoomId room_prison_2_southwest = world.add_room("prison_2_southwest",
+                                                    descriptions::ROOM_PRISON_2_SOUTHWEST);
+    RoomId room_prison_2_middle = world.add_room("prison_2_middle",
+                                                 descriptions::ROOM_PRISON_2_MIDDLE);
+    RoomId room_prison_2_west = world.add_room("prison_2_west", descriptions::ROOM_PRISON_2_WEST);
+    RoomId room_prison_2_east = world.add_room("prison_2_east", descriptions::ROOM_PRISON_2_EAST);
+    RoomId room_prison_2_north = world.add_room("prison_2_north", descriptions::ROOM_PRISON_2_NORTH,
+                                                descriptions::SEARCH_ROOM_PRISON_2_NORTH);
+    RoomId room_prison_2_northwest = world.add_room("prison_2_northwest",
+                                                    descriptions::ROOM_PRISON_2_NORTHWEST,
+                                                    descriptions::SEARCH_ROOM_PRISON_2_NORTHWEST);
+    RoomId room_prison_2_northeast = world.add_room("prison_2_northeast",
+                                                    descriptions::ROOM_PRISON_2_NORTHEAST,
+                                                    descriptions::SEARCH_ROOM_PRISON_2_NORTHEAST);
+    RoomId room_storage_1 = world.add_room("storage_1", descriptions::ROOM_STORAGE_1,
+                                           descriptions::SEARCH_ROOM_STORAGE_1);
+    RoomId room_prison_hallway_9 = world.add_room("prison_hallway_9",
+                                                  descriptions::ROOM_PRISON_HALLWAY_9);
+    RoomId room_prison_hallway_10 = world.add_room("prison_hallway_10",
+                                                   descriptions::ROOM_PRISON_HALLWAY_10);
+    RoomId room_prison_hallway_11 = world.add_room("prison_hallway_11",
+                                                   descriptions::ROOM_PRISON_HALLWAY_11);
+    RoomId room_prison_hallway_12 = world.add_room("prison_hallway_12",
+                                                   descriptions::ROOM_PRISON_HALLWAY_12);
+    RoomId room_cathedral_g1 = world.add_room("cathedral_g1", descriptions::ROOM_CATHEDRAL_G1);
+    RoomId room_cathedral_g2 = world.add_room("cathedral_g2", descriptions::ROOM_CATHEDRAL_G2);
+    RoomId room_cathedral_g3 = world.add_room("cathedral_g3", descriptions::ROOM_CATHEDRAL_G3);
+    RoomId room_cathedral_g4 = world.add_room("cathedral_g4", descriptions::ROOM_CATHEDRAL_G4);
+    RoomId room_cathedral_g5 = world.add_room("cathedral_g5", descriptions::ROOM_CATHEDRAL_G5);
+    RoomId room_cathedral_g6 = world.add_room("cathedral_g6", descriptions::ROOM_CATHEDRAL_G6);
+    RoomId room_cathedral_g7 = world.add_room("cathedral_g7", descriptions::ROOM_CATHEDRAL_G7);
+    RoomId room_cathedral_g8 = world.add_room("cathedral_g8", descriptions::ROOM_CATHEDRAL_G8);
+    RoomId room_cathedral_g9 = world.add_room("cathedral_g9", descriptions::ROOM_CATHEDRAL_G9);
+    RoomId room_cathedral_g10 = world.add_room("cathedral_g10", descriptions::ROOM_CATHEDRAL_G10,
+                                               descriptions::SEARCH_ROOM_CATHEDRAL_G10);
+    RoomId room_cathedral_g11 = world.add_room("cathedral_g11", descriptions::ROOM_CATHEDRAL_G11);
+    RoomId room_cathedral_g12 = world.add_room("cathedral_g12", descriptions::ROOM_CATHEDRAL_G12);
+    RoomId room_cathedral_g13 = world.add_room("cathedral_g13", descriptions::ROOM_CATHEDRAL_G13);
+    RoomId room_cathedral_g14 = world.add_room("cathedral_g14", descriptions::ROOM_CATHEDRAL_G14);
+    RoomId room_cathedral_g15 = world.add_room("cathedral_g15", descriptions::ROOM_CATHEDRAL_G15,
+                                               descriptions::SEARCH_ROOM_CATHEDRAL_G15);
+    RoomId room_cathedral_g16 = world.add_room("cathedral_g16", descriptions::ROOM_CATHEDRAL_G16);
+    RoomId room_cathedral_g17 = world.add_room("cathedral_g17", descriptions::ROOM_CATHEDRAL_G17);
+    RoomId room_cathedral_g18 = world.add_room("cathedral_g18", descriptions::ROOM_CATHEDRAL_G18);
+    RoomId room_cathedral_g19 = world.add_room("cathedral_g19", descriptions::ROOM_CATHEDRAL_G19,
+                                               descriptions::SEARCH_ROOM_CATHEDRAL_G19);
+    RoomId room_cathedral_g20 = world.add_room("cathedral_g20", descriptions::ROOM_CATHEDRAL_G20);
+    RoomId room_cathedral_g21 = world.add_room("cathedral_g21", descriptions::ROOM_CATHEDRAL_G21,
+                                               descriptions::SEARCH_ROOM_CATHEDRAL_G21);
+    RoomId room_cathedral_g22 = world.add_room("cathedral_g22", descriptions::ROOM_CATHEDRAL_G22);
+    RoomId room_brother_1_middle = world.add_room("brother_1_middle",
+                                                  descriptions::ROOM_BROTHER_1_MIDDLE);
+    RoomId room_brother_1_south = world.add_room("brother_1_south",
+                                                 descriptions::ROOM_BROTHER_1_SOUTH);
+    RoomId room_brother_1_west = world.add_room("brother_1_west",
+                                                descriptions::ROOM_BROTHER_1_WEST);
+    RoomId room_brother_1_east = world.add_room("brother_1_east",
+                                                descriptions::ROOM_BROTHER_1_EAST);
+    RoomId room_brother_1_southeast = world.add_room("brother_1_southeast",
+                                                     descriptions::ROOM_BROTHER_1_SOUTHEAST);
+    RoomId room_brother_1_southwest = world.add_room("brother_1_southwest",
+                                                     descriptions::ROOM_BROTHER_1_SOUTHWEST);
+    RoomId room_brother_2_middle = world.add_room("brother_2_middle",
+                                                  descriptions::ROOM_BROTHER_2_MIDDLE);
+    RoomId room_brother_2_north = world.add_room("brother_2_north",
+                                                 descriptions::ROOM_BROTHER_2_NORTH);
+    RoomId room_brother_2_south = world.add_room("brother_2_south",
+                                                 descriptions::ROOM_BROTHER_2_SOUTH);
+    RoomId room_brother_2_east = world.add_room("brother_2_east",
+                                                descriptions::ROOM_BROTHER_2_EAST);
+    RoomId room_brother_2_northeast = world.add_room("brother_2_northeast",
+                                                     descriptions::ROOM_BROTHER_2_NORTHEAST);
+    RoomId room_brother_2_southeast = world.add_room("brother_2_southeast",
+                                                     descriptions::ROOM_BROTHER_2_SOUTHEAST);
+    RoomId room_brother_3_middle = world.add_room("brother_3_middle",
+                                                  descriptions::ROOM_BROTHER_3_MIDDLE);
+    RoomId room_brother_3_north = world.add_room("brother_3_north",
+                                                 descriptions::ROOM_BROTHER_3_NORTH);
+    RoomId room_brother_3_south = world.add_room("brother_3_south",
+                                                 descriptions::ROOM_BROTHER_3_SOUTH);
+    RoomId room_brother_3_west = world.add_room("brother_3_west",
+                                                descriptions::ROOM_BROTHER_3_WEST);
+    RoomId room_brother_3_northwest = world.add_room("brother_3_northwest",
+                                                     descriptions::ROOM_BROTHER_3_NORTHWEST);
+    RoomId room_brother_3_southwest = world.add_room("brother_3_southwest",
+                                                     descriptions::ROOM_BROTHER_3_SOUTHWEST);
+
+    // Starting Room Area Items, Doors, Chests
+    world.add_door(room_start_north, "north", Door("cell key"));
+    world.add_item(room_start_south, world.item("cell key"));
+    world.add_item(room_start_east, world.item("rusted knife"));
+
+    // Starting Room Area
+    world.add_room_exit(room_start, "north", room_start_north);
+    world.add_room_exit(room_start, "south", room_start_south);
+    world.add_room_exit(room_start, "east", room_start_east);
+    world.add_room_exit(room_start, "west", room_start_west);
+    world.add_room_exit(room_start_north, "south", room_start);
+    world.add_room_exit(room_start_north, "east", room_start_northeast);
+    world.add_room_exit(room_start_north, "west", room_start_northwest);
+    world.add_room_exit(room_start_northwest, "east", room_start_north);
+    world.add_room_exit(room_start_northwest, "south", room_start_west);
+    world.add_room_exit(room_start_northeast, "west", room_start_north);
+    world.add_room_exit(room_start_northeast, "south", room_start_east);
+    world.add_room_exit(room_start_south, "north", room_start);
+    world.add_room_exit(room_start_south, "east", room_start_southeast);
+    world.add_room_exit(room_start_south, "west", room_start_southwest);
+    world.add_room_exit(room_start_southwest, "north", room_start_west);
+    world.add_room_exit(room_start_southwest, "east", room_start_south);
+    world.add_room_exit(room_start_southeast, "west", room_start_south);
+    world.add_room_exit(room_start_southeast, "north", room_start_east);
+    world.add_room_exit(room_start_west, "north", room_start_northwest);
+    world.add_room_exit(room_start_west, "east", room_start);
+    world.add_room_exit(room_start_west, "south", room_start_southwest);
+    world.add_room_exit(room_start_east, "west", room_start);
+    world.add_room_exit(room_start_east, "north", room_start_northeast);
+    world.add_room_exit(room_start_east, "south", room_start_southeast);
+
+    // Prison Hallway Area
+    world.add_room_exit(room_start_north, "north", room_prison_hallway_1);
+    world.add_room_exit(room_prison_hallway_1, "south", room_start_north);
+    world.add_room_exit(room_prison_hallway_1, "north", room_prison_hallway_2);
+    world.add_room_exit(room_prison_hallway_2, "south", room_prison_hallway_1);
+    world.add_room_exit(room_prison_hallway_2, "north", room_prison_hallway_3);
+    world.add_room_exit(room_prison_hallway_3, "south", room_prison_hallway_2);
+    world.add_room_exit(room_prison_hallway_3, "north", room_prison_hallway_4);
+    world.add_room_exit(room_prison_hallway_4, "south", room_prison_hallway_3);
+    world.add_room_exit(room_prison_hallway_4, "north", room_prison_hallway_7);
+    world.add_room_exit(room_prison_hallway_3, "west", room_prison_hallway_5);
+    world.add_room_exit(room_prison_hallway_5, "east", room_prison_hallway_3);
+    world.add_room_exit(room_prison_hallway_5, "west", room_prison_hallway_6);
+    world.add_room_exit(room_prison_hallway_6, "east", room_prison_hallway_5);
+    world.add_room_exit(room_prison_hallway_6, "west", room_prison_2_southeast);
+    world.add_room_exit(room_prison_hallway_7, "north", room_prison_1_south);
+    world.add_room_exit(room_prison_hallway_7, "south", room_prison_hallway_4);
+    world.add_room_exit(room_prison_hallway_8, "east", room_prison_1_west);
+    world.add_room_exit(room_prison_hallway_8, "west", room_prison_hallway_9);
+    world.add_room_exit(room_prison_hallway_9, "east", room_prison_hallway_8);
+    world.add_room_exit(room_prison_hallway_9, "west", room_prison_hallway_10);
+    world.add_room_exit(room_prison_hallway_10, "east", room_prison_hallway_9);
+    world.add_room_exit(room_prison_hallway_10, "north", room_prison_hallway_11);
+    world.add_room_exit(room_prison_hallway_11, "south", room_prison_hallway_10);
+    world.add_room_exit(room_prison_hallway_11, "north", room_prison_hallway_12);
+    world.add_room_exit(room_prison_hallway_12, "south", room_prison_hallway_11);
+    world.add_room_exit(room_prison_hallway_12, "north", room_cathedral_g21);
+
+    // Items and Chests in Prison Room 1
+    Chest chest_pr_1(world.item("room key"));
+    world.add_chest(room_prison_1_southeast, chest_pr_1);
+
+    // The masked figures all want the blood bottle, and differ only in what they say and drop
+    auto masked_figure = [&](std::string_view description, std::string_view dialogue,
+                             ItemId drops) {
+        return NPC("Masked Figure", description, 5, false, "blood bottle", dialogue,
+                   "blood bottle", descriptions::NPC_MASKED_FIGURE_DRINKS, drops, NO_ITEM);
+    };
+
+    // NPC in Prison Room 1 (NORTH)
+    world.add_npc(room_prison_1_north,
+                  masked_figure("A masked figure stands motionless. It watches you, and you "
+                                "can’t shake the sense it wants something...from you.\n",
+                                "...", world.item("gold key")));
+
+    // Prison Room 1
+    world.add_door(room_prison_1_west, "west", Door("gold key"));
+
+    world.add_room_exit(room_prison_1_south, "south", room_prison_hallway_7);
+    world.add_room_exit(room_prison_1_south, "north", room_prison_1_middle);
+    world.add_room_exit(room_prison_1_south, "east", room_prison_1_southeast);
+    world.add_room_exit(room_prison_1_south, "west", room_prison_1_southwest);
+    world.add_room_exit(room_prison_1_middle, "south", room_prison_1_south);
+    world.add_room_exit(room_prison_1_middle, "east", room_prison_1_east);
+    world.add_room_exit(room_prison_1_middle, "west", room_prison_1_west);
+    world.add_room_exit(room_prison_1_middle, "north", room_prison_1_north);
+    world.add_room_exit(room_prison_1_north, "south", room_prison_1_middle);
+    world.add_room_exit(room_prison_1_north, "east", room_prison_1_northeast);
+    world.add_room_exit(room_prison_1_north, "west", room_prison_1_northwest);
+    world.add_room_exit(room_prison_1_west, "north", room_prison_1_northwest);
+    world.add_room_exit(room_prison_1_west, "east", room_prison_1_middle);
+    world.add_room_exit(room_prison_1_west, "south", room_prison_1_southwest);
+    world.add_room_exit(room_prison_1_east, "north", room_prison_1_northeast);
+    world.add_room_exit(room_prison_1_east, "west", room_prison_1_middle);
+    world.add_room_exit(room_prison_1_east, "south", room_prison_1_southeast);
+    world.add_room_exit(room_prison_1_northeast, "west", room_prison_1_north);
+    world.add_room_exit(room_prison_1_northeast, "south", room_prison_1_east);
+    world.add_room_exit(room_prison_1_northwest, "east", room_prison_1_north);
+    world.add_room_exit(room_prison_1_northwest, "south", room_prison_1_west);
+    world.add_room_exit(room_prison_1_southeast, "north", room_prison_1_east);
+    world.add_room_exit(room_prison_1_southeast, "west", room_prison_1_south);
+    world.add_room_exit(room_prison_1_southwest, "north", room_prison_1_west);
+    world.add_room_exit(room_prison_1_southwest, "east", room_prison_1_south);
+    world.add_room_exit(room_prison_1_west, "west", room_prison_hallway_8);
+
+    // Items and Chests in Prison Room
+    world.add_item(room_prison_2_northeast, world.item("blood-stained key"));
+    Chest chest_pr_2(world.item("obsidian dagger"), {"blood-stained key"});
+    world.add_chest(room_prison_2_northwest, chest_pr_2);
+
+    // Prison Room 2, Torture Chamber
+    world.add_door(room_prison_hallway_6, "west", Door("room key"));
+
+    world.add_room_exit(room_prison_2_southeast, "east", room_prison_hallway_6);
+    world.add_room_exit(room_prison_2_southeast, "west", room_prison_2_south);
+    world.add_room_exit(room_prison_2_southeast, "north", room_prison_2_east);
+    world.add_room_exit(room_prison_2_southwest, "east", room_prison_2_south);
+    world.add_room_exit(room_prison_2_southwest, "north", room_prison_2_west);
+    world.add_room_exit(room_prison_2_south, "east", room_prison_2_southeast);
+    world.add_room_exit(room_prison_2_south, "north", room_prison_2_middle);
+    world.add_room_exit(room_prison_2_south, "west", room_prison_2_southwest);
+    world.add_room_exit(room_prison_2_middle, "south", room_prison_2_south);
+    world.add_room_exit(room_prison_2_middle, "east", room_prison_2_east);
+    world.add_room_exit(room_prison_2_middle, "west", room_prison_2_west);
+    world.add_room_exit(room_prison_2_middle, "north", room_prison_2_north);
+    world.add_room_exit(room_prison_2_north, "south", room_prison_2_middle);
+    world.add_room_exit(room_prison_2_north, "west", room_prison_2_northwest);
+    world.add_room_exit(room_prison_2_north, "east", room_prison_2_northeast);
+    world.add_room_exit(room_prison_2_northwest, "east", room_prison_2_north);
+    world.add_room_exit(room_prison_2_northwest, "south", room_prison_2_west);
+    world.add_room_exit(room_prison_2_northeast, "west", room_prison_2_north);
+    world.add_room_exit(room_prison_2_northeast, "south", room_prison_2_east);
+    world.add_room_exit(room_prison_2_west, "east", room_prison_2_middle);
+    world.add_room_exit(room_prison_2_west, "north", room_prison_2_northwest);
+    world.add_room_exit(room_prison_2_west, "south", room_prison_2_southwest);
+    world.add_room_exit(room_prison_2_east, "west", room_prison_2_middle);
+    world.add_room_exit(room_prison_2_east, "north", room_prison_2_northeast);
+    world.add_room_exit(room_prison_2_east, "south", room_prison_2_southeast);
+
+    // Doors and Items in Room Storage 1
+    world.add_door(room_prison_2_southwest, "west", Door("blood-stained key"));
+    world.add_item(room_storage_1, world.item("blood bottle"));
+
+    // Room Storage 1
+    world.add_room_exit(room_prison_2_southwest, "west", room_storage_1);
+    world.add_room_exit(room_storage_1, "east", room_prison_2_southwest);
+
+    // Doors and Items in Cathedral Room
+    world.add_door(room_prison_hallway_12, "north", Door("gold key"));
+    world.add_door(room_cathedral_g6, "west", Door("gold key"));
+    world.add_door(room_cathedral_g14, "east", Door("gold key"));
+    world.add_door(room_cathedral_g1, "north", Door("gold key"));
+    Chest chest_c1(world.item("ORBIS DEI"), {"pater orbis", "mater orbis", "filius orbis"});
+    world.add_chest(room_cathedral_g10, chest_c1);
+    Chest chest_c2(world.item("mother's heart"));
+    world.add_chest(room_cathedral_g15, chest_c2);
+    Chest chest_c3(world.item("wooden sword"));
+    world.add_chest(room_cathedral_g19, chest_c3);
+
+    // NPCS
+    world.add_npc(room_cathedral_g6,
+                  masked_figure(descriptions::NPC_MASKED_FIGURE,
+                                "The room named Filius contains the son...", world.item("notes")));
+    world.add_npc(room_cathedral_g14,
+                  masked_figure(descriptions::NPC_MASKED_FIGURE,
+                                "The room named Mater houses the mother...",
+                                world.item("torn note")));
+    world.add_npc(room_cathedral_g1,
+                  masked_figure(descriptions::NPC_MASKED_FIGURE, "WORSHIP THY PATER!", NO_ITEM));
+    NPC masked_priest("Masked Priest",
+                      "The priest stands in silence, his white robes soaked through with "
+                      "blood. A gold mask hides his face. You see nothing in his eyes as they "
+                      "stare at you...\nYou also notice a necklace, with a blood vial dangling "
+                      "from his neck...\n",
+                      5, false, "blood bottle",
+                      "Pater Orbis - the eye that judges!\nMater Orbis - the heart that "
+                      "grieves!\nFilius Orbis - the hand that strikes!\nEach must be "
+                      "fed.\nOnly through blood does their silence speak.\nOnly through "
+                      "sacrifice, the cycle will be complete.",
+                      "blood bottle", "Yes. The sacred blood! Drink this with me my brothers!",
+                      world.item("blood necklace"), NO_ITEM);
+    world.add_npc(room_cathedral_g10, masked_priest);
+
+    // Cathedral Room
+    world.add_room_exit(room_cathedral_g21, "south", room_prison_hallway_12);
+    world.add_room_exit(room_cathedral_g21, "west", room_cathedral_g20);
+    world.add_room_exit(room_cathedral_g21, "east", room_cathedral_g22);
+    world.add_room_exit(room_cathedral_g21, "north", room_cathedral_g17);
+    world.add_room_exit(room_cathedral_g20, "east", room_cathedral_g21);
+    world.add_room_exit(room_cathedral_g20, "north", room_cathedral_g16);
+    world.add_room_exit(room_cathedral_g22, "west", room_cathedral_g21);
+    world.add_room_exit(room_cathedral_g22, "north", room_cathedral_g18);
+    world.add_room_exit(room_cathedral_g17, "south", room_cathedral_g21);
+    world.add_room_exit(room_cathedral_g17, "west", room_cathedral_g16);
+    world.add_room_exit(room_cathedral_g17, "east", room_cathedral_g18);
+    world.add_room_exit(room_cathedral_g17, "north", room_cathedral_g10);
+    world.add_room_exit(room_cathedral_g16, "east", room_cathedral_g17);
+    world.add_room_exit(room_cathedral_g16, "west", room_cathedral_g15);
+    world.add_room_exit(room_cathedral_g16, "south", room_cathedral_g20);
+    world.add_room_exit(room_cathedral_g16, "north", room_cathedral_g9);
+    world.add_room_exit(room_cathedral_g15, "east", room_cathedral_g16);
+    world.add_room_exit(room_cathedral_g15, "north", room_cathedral_g8);
+    world.add_room_exit(room_cathedral_g18, "west", room_cathedral_g17);
+    world.add_room_exit(room_cathedral_g18, "east", room_cathedral_g19);
+    world.add_room_exit(room_cathedral_g18, "north", room_cathedral_g11);
+    world.add_room_exit(room_cathedral_g18, "south", room_cathedral_g22);
+    world.add_room_exit(room_cathedral_g19, "west", room_cathedral_g18);
+    world.add_room_exit(room_cathedral_g19, "north", room_cathedral_g12);
+    world.add_room_exit(room_cathedral_g10, "south", room_cathedral_g17);
+    world.add_room_exit(room_cathedral_g10, "west", room_cathedral_g9);
+    world.add_room_exit(room_cathedral_g10, "east", room_cathedral_g11);
+    world.add_room_exit(room_cathedral_g10, "north", room_cathedral_g4);
+    world.add_room_exit(room_cathedral_g9, "south", room_cathedral_g16);
+    world.add_room_exit(room_cathedral_g9, "east", room_cathedral_g10);
+    world.add_room_exit(room_cathedral_g9, "west", room_cathedral_g8);
+    world.add_room_exit(room_cathedral_g9, "north", room_cathedral_g3);
+    world.add_room_exit(room_cathedral_g8, "east", room_cathedral_g9);
+    world.add_room_exit(room_cathedral_g8, "west", room_cathedral_g7);
+    world.add_room_exit(room_cathedral_g8, "south", room_cathedral_g15);
+    world.add_room_exit(room_cathedral_g7, "east", room_cathedral_g8);
+    world.add_room_exit(room_cathedral_g7, "west", room_cathedral_g6);
+    world.add_room_exit(room_cathedral_g6, "east", room_cathedral_g7);
+    world.add_room_exit(room_cathedral_g11, "west", room_cathedral_g10);
+    world.add_room_exit(room_cathedral_g11, "east", room_cathedral_g12);
+    world.add_room_exit(room_cathedral_g11, "south", room_cathedral_g18);
+    world.add_room_exit(room_cathedral_g11, "north", room_cathedral_g5);
+    world.add_room_exit(room_cathedral_g12, "west", room_cathedral_g11);
+    world.add_room_exit(room_cathedral_g12, "east", room_cathedral_g13);
+    world.add_room_exit(room_cathedral_g12, "south", room_cathedral_g19);
+    world.add_room_exit(room_cathedral_g13, "west", room_cathedral_g12);
+    world.add_room_exit(room_cathedral_g13, "east", room_cathedral_g14);
+    world.add_room_exit(room_cathedral_g14, "west", room_cathedral_g13);
+    world.add_room_exit(room_cathedral_g4, "south", room_cathedral_g10);
+    world.add_room_exit(room_cathedral_g4, "east", room_cathedral_g5);
+    world.add_room_exit(room_cathedral_g4, "west", room_cathedral_g3);
+    world.add_room_exit(room_cathedral_g4, "north", room_cathedral_g2);
+    world.add_room_exit(room_cathedral_g3, "east", room_cathedral_g4);
+    world.add_room_exit(room_cathedral_g3, "south", room_cathedral_g9);
+    world.add_room_exit(room_cathedral_g5, "west", room_cathedral_g4);
+    world.add_room_exit(room_cathedral_g5, "south", room_cathedral_g11);
+    world.add_room_exit(room_cathedral_g2, "south", room_cathedral_g4);
+    world.add_room_exit(room_cathedral_g2, "north", room_cathedral_g1);
+    world.add_room_exit(room_cathedral_g1, "south", room_cathedral_g2);
+    world.add_room_exit(room_cathedral_g6, "west", room_brother_2_east);
+    world.add_room_exit(room_cathedral_g1, "north", room_brother_1_south);
+    world.add_room_exit(room_cathedral_g14, "east", room_brother_3_west);
+
+    // Room 2
+
+    // NPC
+
+    NPC filius("The son", "The son sits in the middle of his room, looking for something...\n", 5,
+               false, "wooden sword",
+               "Please help me, I've lost my wooden sword! If you find it, I can give "
+               "you something in return.",
+               "", "That's it! Here you can have this.", world.item("filius orbis"),
+               world.item("filius orbis"));
+    world.add_npc(room_brother_2_middle, filius);
+
+    world.add_room_exit(room_brother_2_east, "east", room_cathedral_g6);
+    world.add_room_exit(room_brother_2_east, "north", room_brother_2_northeast);
+    world.add_room_exit(room_brother_2_east, "south", room_brother_2_southeast);
+    world.add_room_exit(room_brother_2_east, "west", room_brother_2_middle);
+    world.add_room_exit(room_brother_2_northeast, "south", room_brother_2_east);
+    world.add_room_exit(room_brother_2_northeast, "west", room_brother_2_north);
+    world.add_room_exit(room_brother_2_southeast, "north", room_brother_2_east);
+    world.add_room_exit(room_brother_2_southeast, "west", room_brother_2_south);
+    world.add_room_exit(room_brother_2_middle, "east", room_brother_2_east);
+    world.add_room_exit(room_brother_2_middle, "north", room_brother_2_north);
+    world.add_room_exit(room_brother_2_middle, "south", room_brother_2_south);
+    world.add_room_exit(room_brother_2_south, "north", room_brother_2_middle);
+    world.add_room_exit(room_brother_2_south, "east", room_brother_2_southeast);
+    world.add_room_exit(room_brother_2_north, "east", room_brother_2_northeast);
+    world.add_room_exit(room_brother_2_north, "south", room_brother_2_middle);
+
+    // Room 3
+
+    // NPC
+    NPC mater("The mother", "The mother sits in the middle of the room, painting something...\n", 5,
+              false, "mother's heart",
+              "Don't speak to me while I'm painting...\nComeback once you've got "
+              "something worthwhile...",
+              "",
+              "Oh...that's my old project.\nI've taken my heart and sacrificed "
+              "it to our savior!\nYou should try it sometime...",
+              world.item("mater orbis"), world.item("mater orbis"));
+    world.add_npc(room_brother_3_middle, mater);
+
+    world.add_room_exit(room_brother_3_west, "west", room_cathedral_g14);
+    world.add_room_exit(room_brother_3_west, "north", room_brother_3_northwest);
+    world.add_room_exit(room_brother_3_west, "south", room_brother_3_southwest);
+    world.add_room_exit(room_brother_3_west, "east", room_brother_3_middle);
+    world.add_room_exit(room_brother_3_southwest, "north", room_brother_3_west);
+    world.add_room_exit(room_brother_3_southwest, "east", room_brother_3_south);
+    world.add_room_exit(room_brother_3_south, "west", room_brother_3_southwest);
+    world.add_room_exit(room_brother_3_south, "north", room_brother_3_middle);
+    world.add_room_exit(room_brother_3_middle, "west", room_brother_3_west);
+    world.add_room_exit(room_brother_3_middle, "north", room_brother_3_north);
+    world.add_room_exit(room_brother_3_middle, "south", room_brother_3_south);
+    world.add_room_exit(room_brother_3_northwest, "south", room_brother_3_west);
+    world.add_room_exit(room_brother_3_northwest, "east", room_brother_3_north);
+    world.add_room_exit(room_brother_3_north, "west", room_brother_3_northwest);
+    world.add_room_exit(room_brother_3_north, "south", room_brother_3_middle);
+
+    // Room 1
+
+    // NPC
+    NPC pater("The father", "The father sits upon a throne of blood...\n", 5, false,
+              "blood necklace",
+              "Someone stole my blood necklace...\nWhen I find out who did it, "
+              "I'm going to tear their head out of their fleshed body!",
+              "",
+              "You've found it...who had it???\nWas it the priest?\nNo matter, "
+              "here take this and start your ascent...",
+              world.item("pater orbis"), world.item("pater orbis"));
+    world.add_npc(room_brother_1_middle, pater);
+
+    world.add_room_exit(room_brother_1_south, "south", room_cathedral_g1);
+    world.add_room_exit(room_brother_1_south, "west", room_brother_1_southwest);
+    world.add_room_exit(room_brother_1_south, "east", room_brother_1_southeast);
+    world.add_room_exit(room_brother_1_south, "north", room_brother_1_middle);
+    world.add_room_exit(room_brother_1_southwest, "east", room_brother_1_south);
+    world.add_room_exit(room_brother_1_southwest, "north", room_brother_1_west);
+    world.add_room_exit(room_brother_1_southeast, "west", room_brother_1_south);
+    world.add_room_exit(room_brother_1_southeast, "north", room_brother_1_east);
+    world.add_room_exit(room_brother_1_middle, "south", room_brother_1_south);
+    world.add_room_exit(room_brother_1_middle, "west", room_brother_1_west);
+    world.add_room_exit(room_brother_1_middle, "east", room_brother_1_east);
+    world.add_room_exit(room_brother_1_west, "east", room_brother_1_middle);
+    world.add_room_exit(room_brother_1_west, "south", room_brother_1_southwest);
+    world.add_room_exit(room_brother_1_east, "west", room_brother_1_middle);
+    world.add_room_exit(room_brother_1_east, "south", room_brother_1_southeast);
+
+    world.start_room = room_start;
+}
+
+inline WorldTemplate builtin_world() {
+    WorldBuilder world;
+    build_world(world);
+    return WorldTemplate(world.compile());
+}
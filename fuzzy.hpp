@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Typo-tolerant matching of player input. Only words that did not match exactly come here, so
+// the common path pays nothing for it.
+//
+// Distances are Levenshtein distances computed bit-parallel (Myers' algorithm, in Hyyrö's
+// form for whole strings): the typed word is the pattern, one bit per character, and each
+// candidate is scanned a character at a time with a handful of word operations, so checking a
+// vocabulary of a few dozen names takes well under a microsecond.
+
+// Edits a word of this length may contain and still be recognised; short words get none, as
+// nearly everything is one edit away from them
+constexpr size_t typo_allowance(size_t length) {
+    return length < 3 ? 0 : length < 6 ? 1 : 2;
+}
+
+class FuzzyPattern {
+public:
+    static constexpr size_t MAX_LENGTH = 64;
+
+    explicit FuzzyPattern(std::string_view word) : length(word.size()) {
+        if (length > MAX_LENGTH) return; // matches nothing
+        for (size_t i = 0; i < length; i++) {
+            masks[static_cast<uint8_t>(word[i])] |= uint64_t{1} << i;
+        }
+    }
+
+    // Edit distance to `text`, or something above `limit` once it is certain to exceed it
+    size_t distance(std::string_view text, size_t limit) const {
+        if (length > MAX_LENGTH) return limit + 1;
+        if (length == 0) return text.size();
+        size_t gap = text.size() > length ? text.size() - length : length - text.size();
+        if (gap > limit) return limit + 1;
+
+        const uint64_t last = uint64_t{1} << (length - 1);
+        uint64_t positive = ~uint64_t{0}, negative = 0; // vertical deltas of the current column
+        size_t score = length;
+        for (size_t j = 0; j < text.size(); j++) {
+            uint64_t equal = masks[static_cast<uint8_t>(text[j])];
+            uint64_t vertical = equal | negative;
+            uint64_t horizontal = (((equal & positive) + positive) ^ positive) | equal;
+            uint64_t up = negative | ~(horizontal | positive);
+            uint64_t down = positive & horizontal;
+            if (up & last) score++;
+            if (down & last) score--;
+            // The last row can fall by at most one per character left
+            if (score > limit + (text.size() - j - 1)) return limit + 1;
+            up = (up << 1) | 1; // the first row grows by one per character of text
+            down <<= 1;
+            positive = down | ~(vertical | up);
+            negative = up & vertical;
+        }
+        return score;
+    }
+
+private:
+    size_t length;
+    std::array<uint64_t, 256> masks{};
+};
+
+// The one candidate closest to a mistyped word, within its typo allowance. Candidates are
+// offered with an id; several spellings may share one (an NPC's full name and its last word),
+// but two different ids equally close make the word ambiguous, and it matches neither.
+class ClosestMatch {
+public:
+    explicit ClosestMatch(std::string_view word)
+        : pattern(word), limit(typo_allowance(word.size())) {}
+
+    void consider(std::string_view candidate, uint32_t id) {
+        size_t distance = pattern.distance(candidate, limit);
+        if (distance > limit || distance > best) return;
+        if (distance < best) {
+            best = distance;
+            best_id = id;
+            ambiguous = false;
+        } else if (id != best_id) {
+            ambiguous = true;
+        }
+    }
+
+    bool matched() const { return best != SIZE_MAX && !ambiguous; }
+
+    uint32_t id(uint32_t missing) const { return matched() ? best_id : missing; }
+
+private:
+    FuzzyPattern pattern;
+    size_t limit;
+    size_t best = SIZE_MAX;
+    uint32_t best_id = 0;
+    bool ambiguous = false;
+};
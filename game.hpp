@@ -0,0 +1,632 @@
+#pragma once
+
+#include "arena.hpp"
+#include "command.hpp"
+#include "coroutine.hpp"
+#include "locale.hpp"
+#include "metrics.hpp"
+#include "output.hpp"
+#include "save.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <memory_resource>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The game itself: a Session holds one game's state over a shared world, handlers run the
+// player's commands against it, and play_session is the game loop every front end drives, be it
+// the terminal, the server, the fuzzer or the benchmarks.
+
+enum class GameResult { Won, Died, Quit, EndOfInput };
+
+class Session;
+
+// The locale packs sessions can switch to, loaded before any game starts
+inline LocaleShelf &locale_shelf() {
+    static LocaleShelf shelf;
+    return shelf;
+}
+
+// Defined with the other handlers below
+Verb handle_action(std::string_view player_action, Session &session, Output &out);
+
+class Player {
+public:
+    std::pmr::vector<ItemId> player_inventory;
+    bool is_alive = true;
+
+    explicit Player(std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+        : player_inventory(memory) {}
+
+    void add_to_inventory(const WorldTemplate &world, ItemId item, Output &out) {
+        player_inventory.push_back(item);
+        out << world.item_name(item) << " has been added to your inventory.\n\n";
+    }
+
+    bool has_item(ItemId item) const {
+        return item != NO_ITEM && std::find(player_inventory.begin(), player_inventory.end(),
+                                            item) != player_inventory.end();
+    }
+
+    void player_dies() { is_alive = false; }
+};
+
+// One game in progress: the shared world plus the state this game has changed
+class Session {
+public:
+    const WorldTemplate &world;
+    WorldState state;
+    RoomId room_current;
+    Player player;
+    const LocalePack *locale = nullptr; // the world's own text if null
+    std::pmr::string lost_language; // saved in, but no pack for it fits the world; told once
+
+    // Game state is kept in `memory`, usually the session's arena, which must outlive it;
+    // copies keep theirs on the heap
+    explicit Session(const WorldTemplate &world_template,
+                     std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+        : world(world_template), state(world_template, memory),
+          room_current(world_template.start_room()), player(memory), lost_language(memory) {}
+
+    std::pmr::memory_resource *memory() const {
+        return player.player_inventory.get_allocator().resource();
+    }
+
+    const RoomRecord &room() const { return world.rooms()[room_current]; }
+
+    // A description or line of dialogue, in the session's language
+    Text text(TextRef ref) const {
+        if (locale) {
+            if (std::optional<Text> translated = locale->find(ref)) return *translated;
+        }
+        return world.text(ref);
+    }
+
+    // First living NPC in the current room, or NO_NPC
+    uint32_t first_npc() const {
+        auto npcs = world.npcs();
+        for (uint32_t i = 0; i < npcs.size(); i++) {
+            if (npcs[i].room == room_current && state.npc_alive(i)) {
+                return i;
+            }
+        }
+        return NO_NPC;
+    }
+
+    // Living NPC in the current room called `name`, or whose name ends with it so that "figure"
+    // finds the Masked Figure; the first NPC in the room if no name is given
+    uint32_t find_npc(std::string_view name) const {
+        if (name.empty()) return first_npc();
+        NameId name_id = world.find_npc_name(name);
+        auto npcs = world.npcs();
+        for (uint32_t i = 0; i < npcs.size(); i++) {
+            if (npcs[i].room == room_current && state.npc_alive(i) &&
+                npcs[i].name_id == name_id) {
+                return i;
+            }
+        }
+        for (uint32_t i = 0; i < npcs.size(); i++) {
+            std::string_view full_name = world.lowercase_npc_name(npcs[i].name_id);
+            if (npcs[i].room == room_current && state.npc_alive(i) &&
+                full_name.size() > name.size() && full_name.ends_with(name) &&
+                full_name[full_name.size() - name.size() - 1] == ' ') {
+                return i;
+            }
+        }
+        // Allowing for a typo in the full name or its last word ("figre")
+        ClosestMatch match(name);
+        for (uint32_t i = 0; i < npcs.size(); i++) {
+            if (npcs[i].room != room_current || !state.npc_alive(i)) continue;
+            std::string_view full_name = world.lowercase_npc_name(npcs[i].name_id);
+            match.consider(full_name, i);
+            match.consider(full_name.substr(full_name.rfind(' ') + 1), i);
+        }
+        return match.id(NO_NPC);
+    }
+
+    // Kills the NPC and leaves its drop item on the floor to be found by searching
+    void remove_npc(uint32_t npc) {
+        const NpcRecord &record = world.npcs()[npc];
+        state.set_npc_alive(npc, false);
+        if (record.drop_item != NO_ITEM) {
+            state.set_room_item(record.room, record.drop_item);
+            state.set_room_searched(record.room, false);
+        }
+    }
+
+    void print_description(Output &out) const {
+        out << text(room().description) << "\n";
+        auto npcs = world.npcs();
+        for (uint32_t i = 0; i < npcs.size(); i++) {
+            if (npcs[i].room == room_current && state.npc_alive(i)) {
+                out << text(npcs[i].description) << "\n";
+            }
+        }
+    }
+
+    void print_inventory(Output &out) const {
+        if (player.player_inventory.empty()) {
+            out << "\nYour inventory is empty.\n";
+        } else {
+            out << "\nInventory:\n";
+            for (ItemId item : player.player_inventory) {
+                out << "- " << world.item_name(item) << ": "
+                    << text(world.items()[item].description) << "\n";
+            }
+        }
+    }
+
+    void print_search_description(Output &out) {
+        Text search_description = text(room().search_description);
+        state.set_room_searched(room_current, true);
+        ItemId item = state.room_item(room_current);
+        if (item != NO_ITEM) {
+            if (!search_description.empty()) {
+                out << search_description << "\n";
+            }
+            out << "You found a " << world.item_name(item) << ".\n";
+            out << "\nType 'take' to pick it up.\n\n";
+        } else if (!search_description.empty()) {
+            out << search_description << "\n";
+        } else {
+            out << "You find nothing of interest.\n\n";
+        }
+    }
+
+    bool can_unlock_door(uint32_t door) const {
+        return player.has_item(world.doors()[door].required_key);
+    }
+
+    bool can_unlock_chest(uint32_t chest) const {
+        for (ItemId required : world.keys(world.chests()[chest])) {
+            if (!player.has_item(required)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Everything this game changed, as a compact record (see save.hpp)
+    std::string save() const {
+        return write_save(world, locale ? locale->language() : std::string_view{}, room_current,
+                          player.player_inventory, state);
+    }
+
+    // Throws, leaving the game as it was, if the record cannot be restored in this world. A
+    // language whose pack is gone or no longer fits the world falls back to the world's own
+    // text, and the player is told so with tell_lost_language.
+    void load(std::string_view record) {
+        std::string language;
+        read_save(world, record, language, room_current, player.player_inventory, state);
+        player.is_alive = true;
+        locale = language.empty() ? nullptr : locale_shelf().find(language, world);
+        lost_language.assign(locale || language.empty() ? std::string_view{} : language);
+    }
+
+    void tell_lost_language(Output &out) {
+        if (lost_language.empty()) return;
+        out << "This game was played in " << std::string_view(lost_language)
+            << ", which is not available any more; carrying on in the original text.\n\n";
+        lost_language.clear();
+    }
+
+    void print_chest_required_keys(uint32_t chest, Output &out) const {
+        auto keys = world.keys(world.chests()[chest]);
+        for (size_t i = 0; i < keys.size(); i++) {
+            out << world.item_name(keys[i]);
+            if (i != keys.size() - 1) out << ", ";
+        }
+    }
+};
+
+inline void attempt_move(Session &session, Direction direction, Output &out) {
+    const ExitRecord &exit = session.world.exit(session.room_current, direction);
+    if (exit.target == NO_ROOM) {
+        out << "You can't go that way.\n\n";
+        return;
+    }
+
+    if (exit.door != NO_DOOR && session.state.door_locked(exit.door)) {
+        out << "The door is locked. Maybe there's a key nearby...\n\n";
+        return;
+    }
+
+    session.room_current = exit.target;
+    session.print_description(out);
+}
+
+inline void try_open_door(Session &session, Output &out) {
+    for (const ExitRecord &exit : session.world.exits(session.room_current)) {
+        uint32_t door = exit.door;
+        if (door != NO_DOOR && session.state.door_locked(door)) {
+            if (session.can_unlock_door(door)) {
+                out << "You use the "
+                    << session.world.item_name(session.world.doors()[door].required_key)
+                    << " to unlock the door.\n\n";
+                session.state.set_door_locked(door, false);
+                return; // unlock just one door at a time
+            } else {
+                out << "The door is locked.\n\n";
+                return;
+            }
+        }
+    }
+    out << "There is no locked door here that you can open.\n\n";
+}
+
+inline void talk_to_npc(Session &session, std::string_view npc_name, Output &out) {
+    uint32_t npc = session.find_npc(npc_name);
+    if (npc != NO_NPC) {
+        const NpcRecord &record = session.world.npcs()[npc];
+        out << session.world.text(record.name) << ": " << session.text(record.dialogue) << "\n\n";
+    } else {
+        out << "There is no one to talk to...\n\n";
+    }
+}
+
+inline void give_item_to_npc(Session &session, std::string_view item_name,
+                             std::string_view recipient, Output &out) {
+    // Find the NPC, or the first one in the room
+    uint32_t npc_index = session.find_npc(recipient);
+    if (npc_index == NO_NPC) {
+        out << "There is no one to give the item to...\n\n";
+        return;
+    }
+    const WorldTemplate &world = session.world;
+    const NpcRecord &npc = world.npcs()[npc_index];
+    Text npc_name = world.text(npc.name);
+    WorldState &state = session.state;
+    Player &player = session.player;
+
+    // Give the required item
+    if (npc.required_item == NO_ITEM) {
+        out << npc_name << " doesn't seem interested in anything you have.\n";
+        return;
+    }
+
+    // Find item in player's inventory
+    ItemId item = world.find_item(item_name);
+    if (item == NO_ITEM && (item = world.find_item_near(item_name)) != NO_ITEM) {
+        item_name = world.item_name(item); // what the player meant, not what they typed
+    }
+    auto i = std::find(player.player_inventory.begin(), player.player_inventory.end(), item);
+
+    if (i != player.player_inventory.end()) {
+        // Check if the item matches what the NPC wants
+        if (item == npc.required_item) {
+            state.set_npc_received(npc_index, state.npc_received(npc_index) + 1);
+            player.player_inventory.erase(i);
+            out << "You gave the " << item_name << " to " << npc_name << ".\n\n";
+
+            if (npc.post_receive_item_dialogue.length != 0) {
+                out << session.text(npc.post_receive_item_dialogue) << "\n";
+            }
+
+            if (npc.give_player_item != NO_ITEM && !state.npc_gave_item(npc_index)) {
+                out << npc_name << " gives you a " << world.item_name(npc.give_player_item)
+                    << ".\n\n";
+                player.add_to_inventory(world, npc.give_player_item, out);
+                state.set_npc_gave_item(npc_index, true);
+            }
+        } else {
+            out << npc_name << " doesn't want that item.\n\n";
+        }
+
+        if (item == npc.death_item) {
+            state.set_npc_health(npc_index, 0);
+            out << npc_name << " falls to the ground and dies...\n\n";
+            session.remove_npc(npc_index);
+        }
+    } else {
+        out << "You don't have that item...\n\n";
+    }
+}
+
+inline void attack_npc(Session &session, std::string_view npc_name, Output &out) {
+    uint32_t npc_index = session.find_npc(npc_name);
+    if (npc_index != NO_NPC) {
+        Text name = session.world.text(session.world.npcs()[npc_index].name);
+        WorldState &state = session.state;
+        const RuleItems &rules = session.world.rule_items();
+        int max_damage = 1; // Default damage
+
+        if (session.player.has_item(rules.rusted_knife)) {
+            max_damage = std::max(max_damage, 2);
+        }
+        if (session.player.has_item(rules.obsidian_dagger)) {
+            max_damage = std::max(max_damage, 5);
+        }
+
+        int health = state.npc_health(npc_index) - max_damage;
+        state.set_npc_health(npc_index, health);
+        if (health <= 0) {
+            out << name << " was murdered...\n\n";
+        } else {
+            out << "You attacked " << name << ".\n\n";
+        }
+        int required_damage = 5;
+
+        if (max_damage >= required_damage) {
+            if (health <= 0) {
+                session.remove_npc(npc_index);
+            }
+        } else {
+            out << "The " << name << " stands, and without hesitation...\nslices your throat.\n";
+            session.player.player_dies();
+            return;
+        }
+    } else {
+        out << "There is no one to attack...\n";
+    }
+}
+
+inline bool check_victory(const Session &session, Output &out) {
+    if (session.player.has_item(session.world.rule_items().orbis_dei)) {
+        out << "\nYou feel an impossible weight settle in your "
+               "hands...\nYou hear the heavens call upon you...\nThe ORBIS "
+               "DEI hums with unknowable power...\nEverything "
+               "fades...\nThanks for playing!!!\n\n";
+        return true;
+    }
+    return false;
+}
+
+inline void begin_game(Session &session, Output &out) {
+    out << "\nInitializing TENEBRAE...\n\nYou wake up in dimly lit room...\n";
+    session.print_description(out);
+}
+
+// Ends the game if the last action decided it, otherwise asks for the next action
+inline std::optional<GameResult> prompt_action(Session &session, Output &out) {
+    if (!session.player.is_alive) {
+        out << "\nYou died...\n";
+        return GameResult::Died;
+    }
+    if (check_victory(session, out)) {
+        return GameResult::Won;
+    }
+    out << "\nACTION: ";
+    return std::nullopt;
+}
+
+// Runs one line of input, timing it into this thread's metrics
+inline Verb play_action(Session &session, std::string &player_action, Output &out) {
+    auto started = std::chrono::steady_clock::now();
+    for (char &c : player_action) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    out << "\n";
+    session.tell_lost_language(out); // after a restore that could not keep the language
+
+    Verb verb = handle_action(player_action, session, out);
+    local_metrics().record(verb, std::chrono::steady_clock::now() - started);
+    return verb;
+}
+
+// The game loop, suspended between actions; whatever has the player's lines drives it
+inline LineTask<GameResult> play_session(Session &session, Output &greeting) {
+    Output *out = &greeting;
+    begin_game(session, *out);
+    while (true) {
+        if (std::optional<GameResult> result = prompt_action(session, *out)) {
+            co_return *result;
+        }
+        Turn turn = co_await next_line;
+        out = &turn.out;
+        if (play_action(session, turn.line, *out) == Verb::Quit) {
+            co_return GameResult::Quit;
+        }
+    }
+}
+
+// The game as played away from the terminal, where there is no menu to greet the player
+inline LineTask<GameResult> welcome(Session &session, Output &out) {
+    out << "\nWelcome to TENEBRAE...\n";
+    return play_session(session, out);
+}
+
+// Drives a game from a blocking stream, a line at a time
+inline GameResult start_new_game(const WorldTemplate &world, std::istream &in,
+                                 std::ostream &out, uint64_t *commands = nullptr) {
+    SessionArena arena;
+    Session session(world, arena.memory());
+    Output output(arena.memory());
+    LineTask<GameResult> game = play_session(session, output);
+
+    std::string player_action;
+    while (!game.done()) {
+        output.write_to(out);
+        if (!std::getline(in >> std::ws, player_action)) {
+            return GameResult::EndOfInput;
+        }
+        if (commands) ++*commands;
+        game.send(player_action, output);
+    }
+    output.write_to(out);
+    return game.result();
+}
+
+// One handler per verb, indexed by Verb
+inline void search_room(Session &session, const Command &, Output &out) {
+    session.print_search_description(out);
+}
+
+inline void take_item(Session &session, const Command &, Output &out) {
+    WorldState &state = session.state;
+    ItemId item = state.room_item(session.room_current);
+    if (state.room_searched(session.room_current) && item != NO_ITEM) {
+        session.player.add_to_inventory(session.world, item, out);
+        state.set_room_item(session.room_current, NO_ITEM); // prevent double-take
+    } else {
+        out << "You see nothing to take.\nTry searching first...\n\n";
+    }
+}
+
+inline void show_inventory(Session &session, const Command &, Output &out) {
+    session.print_inventory(out);
+}
+
+inline void open_chest_or_door(Session &session, const Command &, Output &out) {
+    uint32_t chest = session.room().chest;
+    if (chest != NO_CHEST && !session.state.chest_opened(chest)) {
+        if (session.state.chest_locked(chest)) {
+            if (session.can_unlock_chest(chest)) {
+                out << "You unlock the chest using the ";
+                session.print_chest_required_keys(chest, out);
+                out << ".\n\n";
+                session.state.set_chest_locked(chest, false);
+            } else {
+                out << "The chest is locked.\n\n";
+                return;
+            }
+        }
+        session.state.set_chest_opened(chest, true);
+        ItemId found_item = session.world.chests()[chest].contained_item;
+        out << "You open the chest and found... " << session.world.item_name(found_item)
+            << "!\n\n";
+        session.player.add_to_inventory(session.world, found_item, out);
+    } else {
+        try_open_door(session, out);
+    }
+}
+
+inline void move(Session &session, const Command &command, Output &out) {
+    attempt_move(session, command.direction, out);
+}
+
+inline void talk(Session &session, const Command &command, Output &out) {
+    talk_to_npc(session, command.object, out);
+}
+
+inline void give(Session &session, const Command &command, Output &out) {
+    if (command.object.empty()) {
+        out << "Give what?\n";
+        return;
+    }
+    give_item_to_npc(session, command.object, command.target, out);
+}
+
+inline void kill_self(Session &session, const Command &, Output &out) {
+    const RuleItems &rules = session.world.rule_items();
+    if (session.player.has_item(rules.rusted_knife)) {
+        out << "You can't handle the darkness...\nYou take the rusted "
+               "knife and plunge it deep into stomach...\n";
+        session.player.player_dies();
+    } else if (session.player.has_item(rules.obsidian_dagger)) {
+        out << "The dagger speaks to you...\nIt wants you...\nYou hear "
+               "the voices that come before...\nYou look to the ceiling "
+               "and plunge the dagger into your stomach...\n";
+        session.player.player_dies();
+    } else {
+        out << "You have nothing to kill yourself with...\n";
+    }
+}
+
+inline void attack(Session &session, const Command &command, Output &out) {
+    attack_npc(session, command.object, out);
+}
+
+// Drinking the blood bottle is fatal, so it has to be named exactly; a near miss is only queried
+inline void drink(Session &session, const Command &command, Output &out) {
+    const WorldTemplate &world = session.world;
+    ItemId blood_bottle = world.rule_items().blood_bottle;
+    if (blood_bottle == NO_ITEM || world.find_item(command.object) != blood_bottle) {
+        if (blood_bottle != NO_ITEM && world.find_item_near(command.object) == blood_bottle) {
+            out << "Did you mean 'drink "
+                << std::string_view(to_lowercase(world.item_name(blood_bottle)))
+                << "'? Type it out in full to do that.\n\n";
+        } else {
+            out << "You can't drink that.\n\n";
+        }
+    } else if (session.player.has_item(blood_bottle)) {
+        out << "You begin to drink the blood bottle...\nYou feel the thick "
+               "coagulated blood slide down your throat...\nAt first your body "
+               "wanted to reject it, but after you drink...\nand drink...\nand "
+               "drink...\nYou begin to feel something else...\nBliss...\n";
+        session.player.player_dies();
+    } else {
+        out << "You don't have a blood bottle in your inventory.\n\n";
+    }
+}
+
+inline void save_game(Session &session, const Command &, Output &out) {
+    out << "Game saved. To carry on from here later, enter:\nload "
+        << to_save_code(session.save()) << "\n\n";
+}
+
+inline void load_game(Session &session, const Command &command, Output &out) {
+    if (command.object.empty()) {
+        out << "Load what? Enter the code you were given when you saved.\n\n";
+        return;
+    }
+    try {
+        session.load(from_save_code(command.object));
+    } catch (const std::runtime_error &e) {
+        out << "That save can't be loaded: " << std::string_view(e.what()) << ".\n\n";
+        return;
+    }
+    out << "Game loaded.\n\n";
+    session.tell_lost_language(out);
+    session.print_description(out);
+}
+
+inline void choose_language(Session &session, const Command &command, Output &out) {
+    if (command.object.empty()) {
+        out << "Languages: original";
+        for (std::string_view language : locale_shelf().languages(session.world)) {
+            out << ", " << language;
+        }
+        out << ".\nNow playing in "
+            << (session.locale ? session.locale->language() : std::string_view("original"))
+            << ". Type 'language <name>' to switch.\n\n";
+        return;
+    }
+    const LocalePack *pack = nullptr;
+    if (command.object != "original" &&
+        !(pack = locale_shelf().find(command.object, session.world))) {
+        out << "There is no such language. Type 'language' to see those there are.\n\n";
+        return;
+    }
+    session.locale = pack;
+    out << "Language set to " << command.object << ".\n\n";
+    session.print_description(out);
+}
+
+inline void show_stats(Session &, const Command &, Output &out) {
+    out << "Command latency so far, across every game:\n"
+        << std::string_view(format_latency_table(*collect_metrics())) << "\n";
+}
+
+inline void quit(Session &, const Command &, Output &out) {
+    out << "You decide it's time to stop. Returning to the Main "
+           "Menu.\n";
+}
+
+inline void unknown_action(Session &, const Command &command, Output &out) {
+    if (!command.suggestion.empty()) {
+        out << "Did you mean '" << command.suggestion << "'? Type it out in full to do that.\n\n";
+        return;
+    }
+    out << "You can't do that right now. \nTry search, "
+           "inventory, north, south, east, west, or quit\n\n";
+}
+
+using ActionHandler = void (*)(Session &, const Command &, Output &);
+
+constexpr ActionHandler ACTION_HANDLERS[VERB_COUNT] = {
+    search_room,     take_item,  show_inventory, open_chest_or_door, move,      talk,
+    give,            kill_self,  attack,         drink,              save_game, load_game,
+    choose_language, show_stats, quit,           unknown_action};
+
+// Runs one player action against the current room and reports which verb handled it
+inline Verb handle_action(std::string_view player_action, Session &session, Output &out) {
+    Command command = parse_command(player_action);
+    ACTION_HANDLERS[static_cast<size_t>(command.verb)](session, command, out);
+    return command.verb;
+}
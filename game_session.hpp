@@ -0,0 +1,90 @@
+#pragma once
+
+#include "arena.hpp"
+#include "game.hpp"
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A game hosted in-process, for front ends that drive the engine themselves: commands go in one
+// at a time and what the game says comes back as spans of text, with no stream or socket in
+// between. libtenebrae's C API (tenebrae.h) is a thin layer over this.
+//
+// A session holds its own handle on the world, so the world it was created from may be dropped
+// first. The spans it returns point into its output and the world's text, and stay valid until
+// the next step. Everything else it needs, the output included, comes from its arena; after the
+// first few commands a step allocates nothing. A session may be moved between threads but only
+// used by one at a time.
+
+enum class GameStatus { Playing, Won, Died, Quit };
+
+class GameSession {
+public:
+    static std::unique_ptr<GameSession> create(const WorldTemplate &world) {
+        return std::unique_ptr<GameSession>(new GameSession(world));
+    }
+
+    GameSession(const GameSession &) = delete;
+    GameSession &operator=(const GameSession &) = delete;
+
+    // What the game said last: the greeting, until the first step
+    std::span<const std::string_view> output() const { return pieces; }
+
+    // Plays one command. Blank ones are skipped, as at the terminal, and once the game is over
+    // nothing more is played.
+    std::span<const std::string_view> step(std::string_view command) {
+        out.clear();
+        if (!game.done() && command.find_first_not_of(" \t\r\n\v\f") != std::string_view::npos) {
+            line.assign(command);
+            game.send(line, out);
+        }
+        collect();
+        return pieces;
+    }
+
+    GameStatus status() const {
+        if (!game.done()) return GameStatus::Playing;
+        switch (game.result()) {
+        case GameResult::Won:
+            return GameStatus::Won;
+        case GameResult::Died:
+            return GameStatus::Died;
+        default:
+            return GameStatus::Quit;
+        }
+    }
+
+    // Everything the game changed so far, as a save record (see save.hpp)
+    std::string state() const { return session.save(); }
+
+    // Throws, leaving the game as it was, if the record cannot be restored in this world or
+    // the game is already over
+    void restore(std::string_view record) {
+        if (game.done()) throw std::logic_error("the game is over");
+        session.load(record);
+    }
+
+private:
+    const WorldTemplate world;
+    SessionArena arena;
+    Session session;
+    Output out;
+    std::pmr::vector<std::string_view> pieces;
+    std::string line;
+    LineTask<GameResult> game;
+
+    explicit GameSession(const WorldTemplate &world_template)
+        : world(world_template), session(world, arena.memory()), out(arena.memory()),
+          pieces(arena.memory()), game(welcome(session, out)) {
+        collect();
+    }
+
+    void collect() {
+        pieces.clear();
+        out.for_each_piece([this](std::string_view piece) { pieces.push_back(piece); });
+    }
+};
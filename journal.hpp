@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+
+// Append-only log of the lines a server's sessions were sent, one file per worker, from which the
+// sessions can be rebuilt after a crash. Records are tagged with a session id and a sequence
+// number, the count of lines the session had run once the record applies:
+//   Line       a line the session ran
+//   Snapshot   the session's save record, standing in for every line before it
+//   End        the session is over and need not be rebuilt
+// Appends are buffered and written with a single fdatasync per commit, which the server does
+// once per batch of ready connections, before any of their answers are sent.
+//
+// Each record is a 4-byte FNV-1a checksum of the rest, then LEB128 varints for its length, type,
+// session and sequence, then its data. Reading stops at the first record that is cut short or
+// does not match its checksum, which is where a crash interrupted the last write.
+
+enum class JournalRecord : uint8_t { Line = 1, Snapshot = 2, End = 3 };
+
+struct JournalEntry {
+    JournalRecord type;
+    uint64_t session;
+    uint64_t sequence;
+    std::string data;
+};
+
+namespace detail {
+
+inline uint32_t journal_checksum(std::string_view bytes) {
+    uint32_t hash = 2166136261u;
+    for (char c : bytes) hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    return hash;
+}
+
+inline void put_varint(std::string &out, uint64_t value) {
+    do {
+        out += static_cast<char>((value & 0x7f) | (value > 0x7f ? 0x80 : 0));
+        value >>= 7;
+    } while (value != 0);
+}
+
+// False if the bytes run out first
+inline bool get_varint(std::string_view in, size_t &pos, uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(in[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+} // namespace detail
+
+inline void encode_journal_entry(std::string &out, JournalRecord type, uint64_t session,
+                                 uint64_t sequence, std::string_view data) {
+    std::string body;
+    detail::put_varint(body, static_cast<uint64_t>(type));
+    detail::put_varint(body, session);
+    detail::put_varint(body, sequence);
+    body += data;
+    std::string framed;
+    detail::put_varint(framed, body.size());
+    framed += body;
+    uint32_t checksum = detail::journal_checksum(framed);
+    for (int shift = 0; shift < 32; shift += 8) out += static_cast<char>(checksum >> shift);
+    out += framed;
+}
+
+// Every whole record in a journal file, in the order written; none if it does not exist
+inline std::vector<JournalEntry> read_journal(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<JournalEntry> entries;
+    size_t pos = 0;
+    while (pos + 4 < bytes.size()) {
+        uint32_t checksum = 0;
+        for (int i = 0; i < 4; i++) {
+            checksum |= uint32_t{static_cast<uint8_t>(bytes[pos + i])} << (i * 8);
+        }
+        size_t start = pos + 4, cursor = start;
+        uint64_t length = 0, type = 0;
+        JournalEntry entry{};
+        if (!detail::get_varint(bytes, cursor, length) || length > bytes.size() - cursor) break;
+        size_t end = cursor + length;
+        if (detail::journal_checksum(std::string_view(bytes).substr(start, end - start)) !=
+            checksum) {
+            break;
+        }
+        std::string_view body = std::string_view(bytes).substr(0, end);
+        if (!detail::get_varint(body, cursor, type) ||
+            !detail::get_varint(body, cursor, entry.session) ||
+            !detail::get_varint(body, cursor, entry.sequence) ||
+            type < static_cast<uint64_t>(JournalRecord::Line) ||
+            type > static_cast<uint64_t>(JournalRecord::End)) {
+            break;
+        }
+        entry.type = static_cast<JournalRecord>(type);
+        entry.data.assign(body.substr(cursor));
+        entries.push_back(std::move(entry));
+        pos = end;
+    }
+    return entries;
+}
+
+// What it takes to rebuild one unfinished session: its last snapshot, if any, and the lines
+// it ran after that
+struct JournalSession {
+    std::optional<std::string> snapshot;
+    std::vector<std::string> lines;
+    uint64_t sequence = 0; // lines run in all, counting those the snapshot stands for
+};
+
+// Gathers the records of many journal files, in any order, into the sessions still unfinished
+inline std::map<uint64_t, JournalSession> collect_journal_sessions(
+    std::vector<JournalEntry> entries) {
+    std::stable_sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+        return a.session != b.session ? a.session < b.session : a.sequence < b.sequence;
+    });
+    std::map<uint64_t, JournalSession> sessions;
+    for (size_t first = 0, last; first < entries.size(); first = last) {
+        last = first;
+        while (last < entries.size() && entries[last].session == entries[first].session) last++;
+        bool ended = false;
+        size_t from = first; // after the last snapshot
+        for (size_t i = first; i < last; i++) {
+            ended |= entries[i].type == JournalRecord::End;
+            if (entries[i].type == JournalRecord::Snapshot) from = i;
+        }
+        if (ended) continue;
+
+        JournalSession &session = sessions[entries[first].session];
+        if (entries[from].type == JournalRecord::Snapshot) {
+            session.snapshot = std::move(entries[from].data);
+            session.sequence = entries[from].sequence;
+        }
+        // Lines follow on one by one; one written twice, or lost behind a gap, is skipped
+        for (size_t i = from; i < last; i++) {
+            if (entries[i].type == JournalRecord::Line &&
+                entries[i].sequence == session.sequence + 1) {
+                session.lines.push_back(std::move(entries[i].data));
+                session.sequence++;
+            }
+        }
+    }
+    return sessions;
+}
+
+class Journal {
+public:
+    explicit Journal(std::string path) : path(std::move(path)) { open(); }
+
+    Journal(const Journal &) = delete;
+    Journal &operator=(const Journal &) = delete;
+
+    ~Journal() { ::close(fd); }
+
+    void append(JournalRecord type, uint64_t session, uint64_t sequence,
+                std::string_view data = {}) {
+        encode_journal_entry(buffer, type, session, sequence, data);
+    }
+
+    bool pending() const { return !buffer.empty(); }
+
+    // Bytes in the file, as of the last commit
+    size_t size() const { return written; }
+
+    // Writes everything appended and waits until it is on disk; throws if it could not be
+    void commit() {
+        size_t done = 0;
+        while (done < buffer.size()) {
+            ssize_t n = ::write(fd, buffer.data() + done, buffer.size() - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                buffer.erase(0, done); // so a retry does not write it twice
+                written += done;
+                fail("write");
+            }
+            done += static_cast<size_t>(n);
+        }
+        if (!buffer.empty() && ::fdatasync(fd) != 0) fail("fdatasync");
+        written += buffer.size();
+        buffer.clear();
+    }
+
+    // Replaces the whole file with these records: they are written to a new file, synced and
+    // renamed over the old one, so a crash leaves one or the other. Anything appended and not
+    // committed is kept for the next commit.
+    void rewrite(const std::vector<JournalEntry> &entries) {
+        std::string bytes;
+        for (const JournalEntry &entry : entries) {
+            encode_journal_entry(bytes, entry.type, entry.session, entry.sequence, entry.data);
+        }
+        std::string temporary = path + ".tmp";
+        int out = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (out < 0) fail("open " + temporary);
+        bool ok = ::write(out, bytes.data(), bytes.size()) == static_cast<ssize_t>(bytes.size()) &&
+                  ::fdatasync(out) == 0;
+        ::close(out);
+        if (!ok || ::rename(temporary.c_str(), path.c_str()) != 0) fail("rewrite");
+        sync_directory();
+        ::close(fd);
+        open();
+    }
+
+private:
+    std::string path;
+    int fd = -1;
+    std::string buffer;
+    size_t written = 0;
+
+    void open() {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) fail("open");
+        off_t end = ::lseek(fd, 0, SEEK_END);
+        written = end < 0 ? 0 : static_cast<size_t>(end);
+    }
+
+    // Makes the rename itself durable
+    void sync_directory() const {
+        size_t slash = path.rfind('/');
+        std::string directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+        int dir = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dir < 0) return;
+        ::fsync(dir);
+        ::close(dir);
+    }
+
+    [[noreturn]] void fail(const std::string &what) const {
+        throw std::runtime_error("journal " + path + ": " + what + ": " + std::strerror(errno));
+    }
+};
@@ -0,0 +1,283 @@
+#pragma once
+
+#include "world.hpp"
+#include "world_builder.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <istream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Locale packs: a world's text in another language, one language to a pack. A pack replaces
+// texts by their offset in the world's text pool, so it is made for one compiled world and
+// carries that pool's checksum; it is never used with any other. Names of items and NPCs are
+// left as they are, since they are also the words players type.
+//
+// Packs are written as plain text (export_locale lists every text there is to translate) and
+// compiled into an image laid out like a world's: a header, a table of entries sorted by the
+// offset of the text they replace, and a pool of their own text. Loaded packs are mmap'd, so
+// a pool's pages are only read in once something in them is shown. A session switches language
+// by changing which pack it looks texts up in, a binary search over the entries; no text is
+// copied.
+//
+// Pack definition files use the world file syntax:
+//   language <name>              the name players switch to it by
+//   text <offset> "<text>"       what replaces the world's text at that offset
+
+struct LocaleHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t size;
+    uint32_t world_text_checksum;
+    TextRef language;
+    Section entries;
+    Section text;
+};
+
+struct LocaleEntry {
+    uint32_t source; // offset of the replaced text in the world's pool
+    TextRef text;
+};
+
+constexpr char LOCALE_MAGIC[8] = {'T', 'N', 'B', 'L', 'O', 'C', 'A', 'L'};
+constexpr uint32_t LOCALE_VERSION = 1;
+
+// A text a pack may replace, and where it appears, for translators
+struct TranslatableText {
+    TextRef ref;
+    std::string context;
+};
+
+// Every description and line of dialogue in a world, once each, in the order they come up
+inline std::vector<TranslatableText> translatable_texts(const WorldTemplate &world) {
+    std::vector<TranslatableText> texts;
+    std::set<uint32_t> seen;
+    auto add = [&](TextRef ref, std::string context) {
+        if (ref.length == 0 || !seen.insert(ref.offset).second) return;
+        texts.push_back(TranslatableText{ref, std::move(context)});
+    };
+    for (const RoomRecord &room : world.rooms()) {
+        std::string name(world.text(room.name));
+        add(room.description, "room " + name + " description");
+        add(room.search_description, "room " + name + " search");
+    }
+    for (const ItemRecord &item : world.items()) {
+        add(item.description, "item " + std::string(world.text(item.name)));
+    }
+    for (const NpcRecord &npc : world.npcs()) {
+        std::string name(world.text(npc.name));
+        add(npc.description, "npc " + name + " description");
+        add(npc.dialogue, "npc " + name + " dialogue");
+        add(npc.post_receive_item_dialogue, "npc " + name + " after_gift");
+    }
+    return texts;
+}
+
+// A definition file with every text in the world's own words, to be translated
+inline void export_locale(const WorldTemplate &world, std::ostream &out) {
+    out << "# Tenebrae locale pack: name the language, translate the texts and compile it with\n"
+        << "# --compile-locale. Texts left out, or left as they are, stay in the original.\n\n"
+        << "language \"english\"\n";
+    for (const TranslatableText &text : translatable_texts(world)) {
+        out << "\n# " << text.context << "\ntext " << text.ref.offset << " "
+            << quote_world_string(world.text(text.ref)) << "\n";
+    }
+}
+
+inline std::vector<char> compile_locale(std::istream &in, const std::string &source,
+                                        const WorldTemplate &world) {
+    size_t line_number = 0;
+    auto fail = [&](const std::string &message) {
+        throw std::runtime_error(source + ":" + std::to_string(line_number) + ": " + message);
+    };
+
+    std::map<uint32_t, TextRef> originals;
+    for (const TranslatableText &text : translatable_texts(world)) {
+        originals[text.ref.offset] = text.ref;
+    }
+    std::string language;
+    std::map<uint32_t, std::string> translations;
+    std::string line;
+    while (std::getline(in, line)) {
+        line_number++;
+        std::vector<std::string> tokens;
+        try {
+            tokens = split_world_line(line);
+        } catch (const std::runtime_error &e) {
+            fail(e.what());
+        }
+        if (tokens.empty()) continue;
+
+        if (tokens[0] == "language" && tokens.size() == 2) {
+            language = to_lowercase(tokens[1]);
+        } else if (tokens[0] == "text" && tokens.size() == 3) {
+            uint32_t offset = 0;
+            auto [end, error] = std::from_chars(tokens[1].data(),
+                                                tokens[1].data() + tokens[1].size(), offset);
+            auto original = originals.find(offset);
+            if (error != std::errc() || end != tokens[1].data() + tokens[1].size() ||
+                original == originals.end()) {
+                fail("no text to translate at " + tokens[1]);
+            }
+            if (!translations.emplace(offset, tokens[2]).second) {
+                fail("text " + tokens[1] + " translated twice");
+            }
+        } else {
+            fail("expected language <name> or text <offset> \"<text>\"");
+        }
+    }
+    if (language.empty()) throw std::runtime_error(source + ": no language name");
+
+    std::string text = language;
+    std::vector<LocaleEntry> entries;
+    for (const auto &[offset, translation] : translations) {
+        if (world.text(originals[offset]) == translation) continue; // nothing to replace
+        entries.push_back(LocaleEntry{offset, TextRef{static_cast<uint32_t>(text.size()),
+                                                      static_cast<uint32_t>(translation.size())}});
+        text += translation;
+    }
+
+    LocaleHeader header{};
+    std::memcpy(header.magic, LOCALE_MAGIC, sizeof(LOCALE_MAGIC));
+    header.version = LOCALE_VERSION;
+    header.world_text_checksum = world.text_checksum();
+    header.language = TextRef{0, static_cast<uint32_t>(language.size())};
+    size_t size = (sizeof(LocaleHeader) + 7) & ~size_t{7};
+    header.entries = Section{static_cast<uint32_t>(size), static_cast<uint32_t>(entries.size())};
+    size += entries.size() * sizeof(LocaleEntry);
+    header.text = Section{static_cast<uint32_t>(size), static_cast<uint32_t>(text.size())};
+    size += text.size();
+    if (size > UINT32_MAX) throw std::runtime_error("locale pack is larger than 4GB");
+    header.size = static_cast<uint32_t>(size);
+
+    std::vector<char> image(size);
+    std::memcpy(image.data(), &header, sizeof(header));
+    if (!entries.empty()) {
+        std::memcpy(image.data() + header.entries.offset, entries.data(),
+                    entries.size() * sizeof(LocaleEntry));
+    }
+    std::memcpy(image.data() + header.text.offset, text.data(), text.size());
+    return image;
+}
+
+class LocalePack {
+public:
+    static LocalePack map_file(const std::string &path) {
+        size_t size = 0;
+        LocalePack pack;
+        pack.storage = map_read_only(path, sizeof(LocaleHeader), "locale pack", size);
+        pack.header = reinterpret_cast<const LocaleHeader *>(pack.storage.get());
+        pack.check(path, size);
+        return pack;
+    }
+
+    std::string_view language() const { return text(header->language); }
+
+    // Whether the pack was made for this world's text
+    bool fits(const WorldTemplate &world) const {
+        return header->world_text_checksum == world.text_checksum();
+    }
+
+    // The translation of a world text, if the pack has one
+    std::optional<Text> find(TextRef ref) const {
+        auto i = std::lower_bound(entries().begin(), entries().end(), ref.offset,
+                                  [](const LocaleEntry &entry, uint32_t offset) {
+                                      return entry.source < offset;
+                                  });
+        if (i == entries().end() || i->source != ref.offset) return std::nullopt;
+        return text(i->text);
+    }
+
+private:
+    std::shared_ptr<const char> storage;
+    const LocaleHeader *header = nullptr;
+
+    LocalePack() = default;
+
+    std::span<const LocaleEntry> entries() const {
+        return {reinterpret_cast<const LocaleEntry *>(storage.get() + header->entries.offset),
+                header->entries.count};
+    }
+
+    Text text(TextRef ref) const {
+        return Text({storage.get() + header->text.offset + ref.offset, ref.length});
+    }
+
+    // Unlike a world's records, every entry is checked, as a pack is small and its text refs
+    // are all there is to go wrong
+    void check(const std::string &path, size_t size) const {
+        if (std::memcmp(header->magic, LOCALE_MAGIC, sizeof(LOCALE_MAGIC)) != 0) {
+            throw std::runtime_error(path + " is not a locale pack");
+        }
+        if (header->version != LOCALE_VERSION) {
+            throw std::runtime_error(path + ": unsupported locale pack version " +
+                                     std::to_string(header->version));
+        }
+        const Section table = header->entries, pool = header->text;
+        auto within = [&](TextRef ref) {
+            return ref.offset <= pool.count && ref.length <= pool.count - ref.offset;
+        };
+        bool ok = header->size == size && table.offset % alignof(LocaleEntry) == 0 &&
+                  table.offset <= size &&
+                  table.count <= (size - table.offset) / sizeof(LocaleEntry) &&
+                  pool.offset <= size && pool.count <= size - pool.offset &&
+                  within(header->language);
+        auto records = entries();
+        for (size_t i = 0; ok && i < records.size(); i++) {
+            ok = within(records[i].text) && (i == 0 || records[i - 1].source < records[i].source);
+        }
+        if (!ok) throw std::runtime_error(path + ": truncated or corrupt locale pack");
+    }
+};
+
+// The packs a process offers its sessions. Filled in once, before any session starts, and only
+// read after that.
+class LocaleShelf {
+public:
+    // Loads every pack (*.tlp) in a directory, warning about any not made for this world
+    void load_directory(const std::string &directory, const WorldTemplate &world,
+                        std::ostream &warnings) {
+        std::vector<std::filesystem::path> files;
+        for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".tlp") {
+                files.push_back(entry.path());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        for (const auto &file : files) {
+            packs.push_back(LocalePack::map_file(file.string()));
+            if (!packs.back().fits(world)) {
+                warnings << "warning: locale pack " << file.string()
+                         << " was made for a different world\n";
+            }
+        }
+    }
+
+    // The pack for a language in this world, or null
+    const LocalePack *find(std::string_view language, const WorldTemplate &world) const {
+        for (const LocalePack &pack : packs) {
+            if (pack.language() == language && pack.fits(world)) return &pack;
+        }
+        return nullptr;
+    }
+
+    std::vector<std::string_view> languages(const WorldTemplate &world) const {
+        std::vector<std::string_view> names;
+        for (const LocalePack &pack : packs) {
+            if (pack.fits(world)) names.push_back(pack.language());
+        }
+        return names;
+    }
+
+private:
+    std::vector<LocalePack> packs;
+};
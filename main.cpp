@@ -1,1116 +1,1184 @@
-#include "descriptions.hpp"
+#include "arena.hpp"
+#include "command.hpp"
+#include "coroutine.hpp"
+#include "dungeon.hpp"
+#include "game.hpp"
+#include "locale.hpp"
+#include "metrics.hpp"
+#include "output.hpp"
+#include "published.hpp"
+#include "script.hpp"
+#include "save.hpp"
+#include "scheduler.hpp"
+#ifdef __linux__
+#include "server.hpp" // epoll, accept4 and getrandom: serving is Linux-only
+#endif
+#include "world_validator.hpp"
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 // Func Prototypes
 void print_centered(const std::string &text, size_t width);
-std::string to_lowercase(const std::string &input);
-std::string extract_direction(const std::string &input);
 void show_menu();
-void start_new_game();
+int run_headless(const WorldTemplate &world, const std::string &path, int repeat);
+int serve(const WorldTemplate &world, const std::string &world_path,
+          const std::vector<std::string> &args);
+int solve(const WorldTemplate &world, unsigned threads);
+int fuzz(const WorldTemplate &world, const std::vector<std::string> &args);
+int bench_scheduler(const WorldTemplate &world, const std::vector<std::string> &args);
+void warn_about_world(const WorldTemplate &world);
 void quit_game(bool &game_running);
 
-class Item {
-public:
-    std::string item_name;
-    std::string item_description;
-
-    Item() = default;
+// Functions
+void print_centered(const std::string &text, size_t width = 80) {
+    size_t pad = (width - text.length()) / 2;
+    if (pad > 0) std::cout << std::string(pad, ' ');
+    std::cout << text << '\n';
+}
 
-    Item(const std::string &name, const std::string &description)
-        : item_name(name), item_description(description) {}
-};
+// Headless mode
+const char *result_name(GameResult result) {
+    switch (result) {
+    case GameResult::Won:
+        return "won";
+    case GameResult::Died:
+        return "died";
+    case GameResult::Quit:
+        return "quit";
+    default:
+        return "ran out of commands";
+    }
+}
 
-class NPC {
-public:
-    std::string name;
-    std::string description;
-    int health;
-    bool hostile;
-    std::string required_item;
-    std::string dialogue;
-    std::string death_item;
-    std::string post_receive_item_dialogue;
-    Item *drop_item = nullptr;
-    Item *give_player_item = nullptr;
-    std::vector<Item> inventory;
-
-    NPC(const std::string &npc_name, const std::string &npc_description, int npc_health = 5,
-        bool is_hostile = false, const std::string &npc_required_item = "",
-        const std::string &npc_dialogue = "", const std::string &npc_death_item = "",
-        const std::string &npc_post_receive_item_dialogue = "", Item *npc_drop_item = nullptr,
-        Item *npc_give_player_item = nullptr)
-        : name(npc_name), description(npc_description), health(npc_health), hostile(is_hostile),
-          required_item(npc_required_item), dialogue(npc_dialogue), death_item(npc_death_item),
-          post_receive_item_dialogue(npc_post_receive_item_dialogue), drop_item(npc_drop_item),
-          give_player_item(npc_give_player_item) {}
-
-    void talk() const { std::cout << name << ": " << dialogue << "\n\n"; }
-
-    void receive_item(const Item &item) { inventory.push_back(item); }
-
-    void take_damage(int damage) {
-        health -= damage;
-        if (health <= 0) {
-            std::cout << name << " was murdered...\n\n";
-        } else {
-            std::cout << "You attacked " << name << ".\n\n";
+int run_headless(const WorldTemplate &world, const std::string &path, int repeat) {
+    std::vector<Script> scripts;
+    if (std::filesystem::is_directory(path)) {
+        std::vector<std::filesystem::path> files;
+        for (const auto &entry : std::filesystem::directory_iterator(path)) {
+            if (entry.is_regular_file()) files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+        for (const auto &file : files) {
+            if (!load_script(file, scripts)) return 1;
         }
+    } else if (!load_script(path, scripts)) {
+        return 1;
     }
-
-    bool can_accept_item(const Item &item) {
-        return required_item.empty() || to_lowercase(item.item_name) == to_lowercase(required_item);
+    if (scripts.empty()) {
+        std::cerr << "No scripts found in " << path << "\n";
+        return 1;
     }
-
-    bool can_be_killed_with_item(const std::string &item_name) {
-        return to_lowercase(item_name) == to_lowercase(death_item);
+    repeat = std::max(repeat, 1);
+
+    NullBuffer null_buffer;
+    std::ostream sink(&null_buffer);
+    std::vector<GameResult> results(scripts.size());
+    std::vector<uint64_t> commands(scripts.size());
+    uint64_t playthroughs = 0;
+    uint64_t total_commands = 0;
+
+    auto started = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < scripts.size(); i++) {
+            std::istringstream in(scripts[i].commands);
+            commands[i] = 0;
+            results[i] = start_new_game(world, in, sink, &commands[i]);
+            total_commands += commands[i];
+            playthroughs++;
+        }
     }
-};
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::cout << "Headless run: " << scripts.size() << " script(s) x " << repeat
+              << " repetition(s)\n";
+    for (size_t i = 0; i < scripts.size(); i++) {
+        std::cout << "  " << scripts[i].path << ": " << result_name(results[i]) << " after "
+                  << commands[i] << " commands\n";
+    }
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "\nPlaythroughs: " << playthroughs << " in " << seconds << "s ("
+              << std::setprecision(1) << playthroughs / seconds << " playthroughs/sec)\n";
+    std::cout << "Commands:     " << total_commands << " in " << std::setprecision(3) << seconds
+              << "s (" << std::setprecision(1) << total_commands / seconds << " commands/sec)\n\n";
+    std::cout << format_latency_table(*collect_metrics());
+    return 0;
+}
 
-class Door {
-private:
-    bool locked;
-    std::string required_key;
+void show_menu() {
+    std::cout << "\n\n";
+    print_centered("<============================>");
+    print_centered("TENEBRAE");
+    print_centered("Main Menu");
+    std::cout << "\n";
+    print_centered("    [1] New Game      ");
+    print_centered("    [2] Quit          ");
+    std::cout << "\n";
+    print_centered("Enter [1] or [2]");
+    print_centered(" <============================>\n");
+}
 
-public:
-    Door(const std::string &key = "") : locked(!key.empty()), required_key(to_lowercase(key)) {}
+void quit_game(bool &game_running) {
+    std::cout << "\nQuitting...\n";
+    game_running = false;
+}
 
-    bool is_locked() const { return locked; }
+// Solver
+// Finds the shortest winning playthrough by searching over game states. Walking never changes
+// anything but the player's room, so the search only branches on actions that do, each played
+// through handle_action on a copy of a Session so it follows the game's own rules, and reaches
+// the room it happens in by a shortest walk. A transition costs the walk plus its commands, and
+// states are expanded in order of cost: all states in the cheapest bucket are expanded in
+// parallel, with states already reached kept in a sharded visited set along with the cheapest
+// cost seen for them.
+//
+// Actions that cannot bring the player closer to winning are not tried: picking up items nothing
+// asks for, a second copy of an item that is only ever checked for, searching without taking,
+// unlocking a door without walking through it, and dealing with NPCs that have nothing useful
+// left to give.
+
+struct SolverItems {
+    std::vector<uint8_t> useful;     // some rule, door, chest or NPC asks for it
+    std::vector<uint8_t> consumable; // an NPC takes it, so a second copy can matter
+};
 
-    bool can_unlock(const std::vector<Item> &inventory) const {
-        for (const auto &item : inventory) {
-            if (to_lowercase(item.item_name) == required_key) {
-                return true;
-            }
-        }
-        return false;
+SolverItems solver_items(const WorldTemplate &world) {
+    SolverItems items{std::vector<uint8_t>(world.items().size(), false),
+                      std::vector<uint8_t>(world.items().size(), false)};
+    auto mark = [](std::vector<uint8_t> &flags, ItemId item) {
+        if (item != NO_ITEM) flags[item] = true;
+    };
+    for (const DoorRecord &door : world.doors()) mark(items.useful, door.required_key);
+    for (ItemId key : world.chest_keys()) mark(items.useful, key);
+    for (const NpcRecord &npc : world.npcs()) {
+        mark(items.useful, npc.required_item);
+        mark(items.consumable, npc.required_item);
+        mark(items.useful, npc.death_item);
+        mark(items.consumable, npc.death_item);
     }
+    // The rusted knife is not: an attack only survives with the dagger
+    const RuleItems &rules = world.rule_items();
+    mark(items.useful, rules.obsidian_dagger);
+    mark(items.useful, rules.orbis_dei);
+    return items;
+}
 
-    void unlock() { locked = false; }
-
-    std::string get_required_key() const { return required_key; }
-};
+bool worth_having(const Session &session, const SolverItems &items, ItemId item) {
+    return item != NO_ITEM && items.useful[item] &&
+           (items.consumable[item] || !session.player.has_item(item));
+}
 
-class Chest {
-private:
-    bool locked;
-    std::vector<std::string> required_keys;
-    Item contained_item;
-    bool opened = false;
+// The parts of a session that decide what can happen next, packed into a string
+std::string state_key(const Session &session, const SolverItems &items) {
+    std::string key;
+    auto put = [&key](uint32_t value) { // LEB128
+        do {
+            key += static_cast<char>((value & 0x7f) | (value > 0x7f ? 0x80 : 0));
+            value >>= 7;
+        } while (value != 0);
+    };
+
+    put(session.room_current);
+    std::vector<ItemId> inventory;
+    for (ItemId item : session.player.player_inventory) {
+        if (items.useful[item]) inventory.push_back(item);
+    }
+    std::sort(inventory.begin(), inventory.end());
+    put(static_cast<uint32_t>(inventory.size()));
+    for (ItemId item : inventory) put(item);
+
+    // The world state as it is, less what cannot matter: whether a room was searched once
+    // nothing useful is left there, the health of the dead, and how often NPCs were given things
+    WorldState state = session.state;
+    for (RoomId room = 0; room < session.world.rooms().size(); room++) {
+        ItemId item = state.room_item(room);
+        if (item == NO_ITEM || !items.useful[item]) {
+            state.set_room_item(room, NO_ITEM);
+            state.set_room_searched(room, false);
+        }
+    }
+    for (uint32_t npc = 0; npc < session.world.npcs().size(); npc++) {
+        state.set_npc_received(npc, 0);
+        if (!state.npc_alive(npc)) state.set_npc_health(npc, 0);
+    }
+    auto words = state.raw();
+    key.append(reinterpret_cast<const char *>(words.data()), words.size_bytes());
+    return key;
+}
 
+// Remembers the cheapest cost each state was reached at
+class VisitedSet {
 public:
-    Chest(const Item &item, const std::vector<std::string> &keys = {})
-        : locked(!keys.empty()), contained_item(item) {
-        for (const auto &key : keys) {
-            required_keys.push_back(to_lowercase(key));
+    // True if the state is new or was only reached at a higher cost before
+    bool improve(std::string key, uint32_t cost) {
+        Shard &shard = shards[std::hash<std::string>{}(key) % SHARDS];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto [i, inserted] = shard.costs.try_emplace(std::move(key), cost);
+        if (inserted || cost < i->second) {
+            i->second = cost;
+            return true;
         }
+        return false;
     }
 
-    bool is_locked() const { return locked; }
+    bool is_cheapest(const std::string &key, uint32_t cost) {
+        Shard &shard = shards[std::hash<std::string>{}(key) % SHARDS];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.costs.at(key) == cost;
+    }
 
-    bool is_opened() const { return opened; }
+private:
+    static constexpr size_t SHARDS = 256;
 
-    bool can_unlock(const std::vector<Item> &inventory) const {
-        std::vector<std::string> inventory_keys;
-        for (const auto &item : inventory) {
-            inventory_keys.push_back(to_lowercase(item.item_name));
-        }
-        for (const auto &required : required_keys) {
-            if (std::find(inventory_keys.begin(), inventory_keys.end(), required) ==
-                inventory_keys.end()) {
-                return false;
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, uint32_t> costs;
+    };
+
+    std::array<Shard, SHARDS> shards;
+};
+
+// Rooms the player can walk to without unlocking anything, with the room each was first
+// reached from
+void walk_from(const Session &session, std::vector<uint32_t> &distance,
+               std::vector<RoomId> &previous) {
+    const WorldTemplate &world = session.world;
+    distance.assign(world.rooms().size(), UINT32_MAX);
+    previous.assign(world.rooms().size(), NO_ROOM);
+    std::vector<RoomId> queue{session.room_current};
+    distance[session.room_current] = 0;
+    for (size_t head = 0; head < queue.size(); head++) {
+        RoomId room = queue[head];
+        for (const ExitRecord &exit : world.exits(room)) {
+            if (exit.target == NO_ROOM || distance[exit.target] != UINT32_MAX ||
+                (exit.door != NO_DOOR && session.state.door_locked(exit.door))) {
+                continue;
             }
+            distance[exit.target] = distance[room] + 1;
+            previous[exit.target] = room;
+            queue.push_back(exit.target);
         }
-        return true;
     }
+}
 
-    void unlock() { locked = false; }
-
-    Item open() {
-        opened = true;
-        return contained_item;
+using SolverAction = std::vector<std::string>;
+
+// Commands that could bring the player closer to winning from their current room
+void candidate_actions(const Session &session, const SolverItems &items,
+                       std::vector<SolverAction> &actions) {
+    const WorldTemplate &world = session.world;
+    actions.clear();
+    if (worth_having(session, items, session.state.room_item(session.room_current))) {
+        actions.push_back(session.state.room_searched(session.room_current)
+                              ? SolverAction{"take"}
+                              : SolverAction{"search", "take"});
     }
 
-    std::string get_required_key() const {
-        std::string result;
-        for (size_t i = 0; i < required_keys.size(); i++) {
-            result += required_keys[i];
-            if (i != required_keys.size() - 1) result += ", ";
+    // "open" picks the chest first, then the first locked door
+    uint32_t chest = session.room().chest;
+    if (chest != NO_CHEST && !session.state.chest_opened(chest)) {
+        if ((!session.state.chest_locked(chest) || session.can_unlock_chest(chest)) &&
+            worth_having(session, items, world.chests()[chest].contained_item)) {
+            actions.push_back({"open"});
+        }
+    } else {
+        auto exits = world.exits(session.room_current);
+        for (size_t d = 0; d < DIRECTION_COUNT; d++) {
+            if (exits[d].door == NO_DOOR || !session.state.door_locked(exits[d].door)) continue;
+            if (session.can_unlock_door(exits[d].door) && exits[d].target != NO_ROOM) {
+                actions.push_back({"open", std::string(DIRECTION_NAMES[d])});
+            }
+            break;
         }
-        return result;
     }
-};
 
-class Player {
-public:
-    std::vector<Item> player_inventory;
-    bool is_alive = true;
-
-    void add_to_inventory(const Item &item) {
-        player_inventory.push_back(item);
-        std::cout << item.item_name << " has been added to your inventory.\n\n";
+    uint32_t npc_index = session.first_npc();
+    if (npc_index != NO_NPC) {
+        const NpcRecord &npc = world.npcs()[npc_index];
+        // What an NPC drops is picked up right away, since coming back for it only costs more
+        if (worth_having(session, items, npc.drop_item)) {
+            actions.push_back({"attack", "search", "take"});
+            if (session.player.has_item(npc.death_item)) {
+                actions.push_back(
+                    {"give " + to_lowercase(world.item_name(npc.death_item)), "search", "take"});
+            }
+        }
+        if (!session.state.npc_gave_item(npc_index) &&
+            worth_having(session, items, npc.give_player_item) &&
+            session.player.has_item(npc.required_item)) {
+            actions.push_back({"give " + to_lowercase(world.item_name(npc.required_item))});
+        }
     }
+}
 
-    void print_inventory() const {
-        if (player_inventory.empty()) {
-            std::cout << "\nYour inventory is empty.\n";
-        } else {
-            std::cout << "\nInventory:\n";
-            for (const auto &item : player_inventory) {
-                std::cout << "- " << item.item_name << ": " << item.item_description << "\n";
+struct SolverNode {
+    Session session;
+    uint32_t parent; // node the walk started from
+    uint32_t cost;   // commands from the start of the game
+    RoomId room;     // where the action was taken
+    SolverAction action;
+};
+
+int solve(const WorldTemplate &world, unsigned threads) {
+    threads = std::max(threads ? threads : std::thread::hardware_concurrency(), 1u);
+    SolverItems items = solver_items(world);
+    auto started = std::chrono::steady_clock::now();
+
+    // Nodes are only appended between rounds, so workers can read them without locking
+    std::vector<SolverNode> nodes{SolverNode{Session(world), 0, 0, NO_ROOM, {}}};
+    std::map<uint32_t, std::vector<uint32_t>> buckets{{0, {0}}};
+    VisitedSet visited;
+    visited.improve(state_key(nodes[0].session, items), 0);
+
+    struct Win {
+        uint32_t cost = UINT32_MAX;
+        uint32_t parent = 0;
+        RoomId room = NO_ROOM;
+        SolverAction action;
+    };
+    Win win;
+    uint64_t expanded = 0;
+
+    while (!buckets.empty() && buckets.begin()->first < win.cost) {
+        std::vector<uint32_t> bucket = std::move(buckets.begin()->second);
+        buckets.erase(buckets.begin());
+
+        std::atomic<size_t> next{0};
+        std::vector<std::vector<SolverNode>> reached(threads);
+        std::vector<Win> wins(threads);
+        auto expand = [&](unsigned thread) {
+            Output scratch;
+            std::vector<uint32_t> distance;
+            std::vector<RoomId> previous;
+            std::vector<SolverAction> actions;
+            for (size_t i; (i = next.fetch_add(1)) < bucket.size();) {
+                const SolverNode &node = nodes[bucket[i]];
+                if (!visited.is_cheapest(state_key(node.session, items), node.cost)) continue;
+                walk_from(node.session, distance, previous);
+                for (RoomId room = 0; room < distance.size(); room++) {
+                    if (distance[room] == UINT32_MAX) continue;
+                    Session there = node.session;
+                    there.room_current = room;
+                    candidate_actions(there, items, actions);
+                    for (const SolverAction &action : actions) {
+                        Session session = there;
+                        for (const std::string &command : action) {
+                            handle_action(command, session, scratch);
+                        }
+                        bool won = session.player.is_alive && check_victory(session, scratch);
+                        scratch.clear();
+                        uint32_t cost =
+                            node.cost + distance[room] + static_cast<uint32_t>(action.size());
+                        Win &best = wins[thread];
+                        if (won && std::tie(cost, bucket[i]) < std::tie(best.cost, best.parent)) {
+                            best = Win{cost, bucket[i], room, action};
+                        } else if (!won && session.player.is_alive &&
+                                   visited.improve(state_key(session, items), cost)) {
+                            reached[thread].push_back(
+                                SolverNode{std::move(session), bucket[i], cost, room, action});
+                        }
+                    }
+                }
             }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; t++) workers.emplace_back(expand, t);
+        expand(0);
+        for (auto &worker : workers) worker.join();
+
+        expanded += bucket.size();
+        for (const Win &found : wins) {
+            if (std::tie(found.cost, found.parent) < std::tie(win.cost, win.parent)) win = found;
         }
+        for (auto &states : reached) {
+            for (auto &node : states) {
+                buckets[node.cost].push_back(static_cast<uint32_t>(nodes.size()));
+                nodes.push_back(std::move(node));
+            }
+        }
+    }
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (win.cost == UINT32_MAX) {
+        std::cerr << "No winning playthrough (" << nodes.size() << " states explored)\n";
+        return 1;
     }
 
-    bool has_item(const std::string &item_name) const {
-        for (const auto &item : player_inventory) {
-            if (item.item_name == item_name) {
-                return true;
+    // Walk back from the winning action, filling in each walk between actions
+    std::vector<std::string> path(win.action.rbegin(), win.action.rend());
+    uint32_t node = win.parent;
+    RoomId target = win.room;
+    std::vector<uint32_t> distance;
+    std::vector<RoomId> previous;
+    while (true) {
+        const Session &from = nodes[node].session;
+        walk_from(from, distance, previous);
+        for (RoomId room = target; room != from.room_current; room = previous[room]) {
+            for (size_t d = 0; d < DIRECTION_COUNT; d++) {
+                if (world.exits(previous[room])[d].target == room) {
+                    path.push_back(std::string(DIRECTION_NAMES[d]));
+                    break;
+                }
             }
         }
-        return false;
+        if (node == 0) break;
+        path.insert(path.end(), nodes[node].action.rbegin(), nodes[node].action.rend());
+        target = nodes[node].room;
+        node = nodes[node].parent;
     }
 
-    void player_dies() { is_alive = false; }
-};
+    std::cout << "# Shortest winning playthrough: " << path.size() << " commands ("
+              << nodes.size() << " states, " << expanded << " expanded in " << std::fixed
+              << std::setprecision(3) << seconds << "s on " << threads << " thread(s))\n";
+    for (auto i = path.rbegin(); i != path.rend(); i++) {
+        std::cout << *i << "\n";
+    }
+    return 0;
+}
+
+// Fuzzing
+// Plays random sessions on many threads to measure throughput and to shake out crashes. Commands
+// follow the game's grammar and use the world's own item and NPC names, with some noise mixed
+// in. Every session is played from its own seed, derived from the run's seed and the session's
+// number, so any session that fails can be replayed exactly with --fuzz-replay; a build with
+// -fsanitize=address,undefined turns undefined behaviour into such failures.
 
-class Room {
+// splitmix64: small, fast, and the same sequence on every platform and standard library
+class FuzzRandom {
 public:
-    std::string room_description;
-    std::string search_description;
-    std::map<std::string, Room *> room_exits;
-    std::map<std::string, Door> doors;
-    std::vector<Item> items;
-    bool has_been_searched = false;
-    Chest *chest = nullptr;
-    std::string revealed_item_name;
-    std::vector<NPC> npcs;
-
-    Room(const std::string &desc, const std::string &search = "")
-        : room_description(desc), search_description(search) {}
-
-    void add_room_exit(const std::string &direction, Room *room) { room_exits[direction] = room; }
-
-    Room *get_exit(const std::string &direction) {
-        auto i = room_exits.find(direction);
-        return i != room_exits.end() ? i->second : nullptr;
+    explicit FuzzRandom(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15u);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+        return z ^ (z >> 31);
     }
 
-    void add_door(const std::string &direction, const Door &door) { doors[direction] = door; }
+    size_t below(size_t n) { return static_cast<size_t>(next() % n); }
 
-    bool has_door(const std::string &direction) const {
-        return doors.find(direction) != doors.end();
+    template <typename T> const T &pick(const std::vector<T> &values) {
+        return values[below(values.size())];
     }
 
-    Door *get_door(const std::string &direction) {
-        auto it = doors.find(direction);
-        return it != doors.end() ? &(it->second) : nullptr;
-    }
+private:
+    uint64_t state;
+};
+
+uint64_t fuzz_session_seed(uint64_t run_seed, uint64_t session) {
+    return FuzzRandom(run_seed ^ (session * 0xd1b54a32d192ed03u)).next();
+}
 
-    void add_chest(Chest *new_chest) { chest = new_chest; }
+// Names a command can refer to, lowercased as the game sees them
+struct FuzzVocabulary {
+    std::vector<std::string> items;
+    std::vector<std::string> npcs;
+    std::vector<std::string> words; // anything, for noise
 
-    void print_description() {
-        std::cout << room_description << "\n";
-        if (!npcs.empty()) {
-            for (const auto &npc : npcs) {
-                std::cout << npc.description << "\n";
+    explicit FuzzVocabulary(const WorldTemplate &world) {
+        for (ItemId item = 0; item < world.items().size(); item++) {
+            items.push_back(to_lowercase(world.item_name(item)));
+        }
+        for (const NpcRecord &npc : world.npcs()) {
+            std::string name(world.lowercase_npc_name(npc.name_id));
+            npcs.push_back(name);
+            npcs.push_back(name.substr(name.rfind(' ') + 1)); // "figure" for the Masked Figure
+        }
+        words = items;
+        words.insert(words.end(), npcs.begin(), npcs.end());
+        for (const KeywordEntry &keyword : KEYWORDS) {
+            // Ending sessions is left to the generator, and stats is slow enough to skew timings
+            if (keyword.keyword != Keyword::Quit && keyword.keyword != Keyword::Stats) {
+                words.emplace_back(keyword.word);
             }
         }
+        words.insert(words.end(), {"", "to", "the", "key", "self", "myself", "!@#$", "north east"});
+        if (npcs.empty()) npcs.push_back("nobody");
+        if (items.empty()) items.push_back("nothing");
     }
+};
 
-    void print_search_description() {
-        has_been_searched = true;
-        if (!revealed_item_name.empty()) {
-            if (!search_description.empty()) {
-                std::cout << search_description << "\n";
-            }
-            std::cout << "You found a " << revealed_item_name << ".\n";
-            std::cout << "\nType 'take' to pick it up.\n\n";
-        } else if (!search_description.empty()) {
-            std::cout << search_description << "\n";
-        } else {
-            std::cout << "You find nothing of interest.\n\n";
-        }
+// A word with one letter changed, as a player might mistype it
+std::string mistype(FuzzRandom &random, std::string word) {
+    if (!word.empty()) word[random.below(word.size())] = static_cast<char>('a' + random.below(26));
+    return word;
+}
 
-        if (!revealed_item_name.empty()) {
+std::string fuzz_command(FuzzRandom &random, const FuzzVocabulary &words, const Session &session) {
+    size_t roll = random.below(100);
+    if (roll < 30) {
+        std::string direction(DIRECTION_NAMES[random.below(DIRECTION_COUNT)]);
+        return random.below(4) == 0 ? "go " + direction : direction;
+    }
+    if (roll < 38) return "search";
+    if (roll < 46) return "take";
+    if (roll < 54) return random.below(4) == 0 ? "use key" : "open";
+    if (roll < 60) return random.below(2) ? "talk" : "talk to " + random.pick(words.npcs);
+    if (roll < 70) {
+        std::string command = "give " + random.pick(words.items);
+        return random.below(2) ? command : command + " to " + random.pick(words.npcs);
+    }
+    if (roll < 76) return random.below(2) ? "attack" : "kill " + random.pick(words.npcs);
+    if (roll < 78) return "inventory";
+    if (roll < 80) {
+        std::string verb = "drink", item = random.pick(words.items);
+        if (random.below(4) == 0) {
+            std::string &word = random.below(2) ? verb : item;
+            word = mistype(random, word);
         }
+        return verb + " " + item;
     }
-
-    bool has_been_searched_by_player() const { return has_been_searched; }
-
-    void reset_search_status() {
-        has_been_searched = false;
-        revealed_item_name = "";
+    if (roll < 81) return random.below(2) ? "kill self" : "suicide";
+    if (roll < 83) return "save";
+    if (roll < 85) {
+        // The session's own state, sometimes with a character changed
+        std::string code = to_save_code(session.save());
+        if (random.below(2)) code[random.below(code.size())] = "a7z"[random.below(3)];
+        return "load " + code;
     }
+    if (roll < 86 && random.below(8) == 0) return "quit";
+    std::string noise = random.pick(words.words);
+    for (size_t n = random.below(3); n > 0; n--) noise += " " + random.pick(words.words);
+    return noise;
+}
 
-    void add_item(const Item &item) { items.push_back(item); }
+// Describes the first broken invariant, or returns an empty string
+std::string check_session(const Session &session) {
+    const WorldTemplate &world = session.world;
+    if (session.room_current >= world.rooms().size()) return "player is in no room";
+    for (ItemId item : session.player.player_inventory) {
+        if (item >= world.items().size()) return "inventory holds an unknown item";
+    }
+    for (RoomId room = 0; room < world.rooms().size(); room++) {
+        ItemId item = session.state.room_item(room);
+        if (item != NO_ITEM && item >= world.items().size()) return "a room holds an unknown item";
+    }
+    return {};
+}
 
-    Item *find_item(const std::string &item_name) {
-        for (auto &item : items) {
-            if (to_lowercase(item.item_name) == item_name) {
-                return &item;
-            }
-        }
-        return nullptr;
+// Describes a death the player did not ask for in so many words: a mistyped verb, or a drink of
+// something not named exactly. Empty if the command was spelled out.
+std::string check_death(const Session &session, std::string_view command) {
+    Tokenizer tokens(command);
+    if (find_keyword(tokens.next()) == Keyword::None) return "died on a mistyped command";
+    Command parsed = parse_command(command);
+    if (parsed.verb == Verb::Drink && session.world.find_item(parsed.object) == NO_ITEM) {
+        return "died drinking a mistyped item";
     }
+    return {};
+}
 
-    bool remove_item(const std::string &item_name) {
-        auto it = std::remove_if(items.begin(), items.end(),
-                                 [&](Item &i) { return to_lowercase(i.item_name) == item_name; });
-        if (it != items.end()) {
-            items.erase(it, items.end());
-            return true;
-        }
-        return false;
+// A copy of the world's image with one word of its record tables overwritten, as a corrupt or
+// half-written file might have it, if the copy is still accepted as a world; loading it has to
+// reject anything a game would trip over
+std::optional<WorldTemplate> corrupt_world(const WorldTemplate &world, uint64_t seed,
+                                           std::ostream *transcript) {
+    FuzzRandom random(seed ^ 0x636f7272757074u);
+    std::string_view bytes = world.bytes();
+    std::vector<char> image(bytes.begin(), bytes.end());
+    WorldHeader header;
+    std::memcpy(&header, image.data(), sizeof(header));
+    size_t words = (header.text.offset - sizeof(WorldHeader)) / sizeof(uint32_t);
+    size_t offset = sizeof(WorldHeader) + random.below(words) * sizeof(uint32_t);
+    uint32_t value = random.below(3) == 0   ? UINT32_MAX // NO_ITEM, NO_ROOM and the like
+                     : random.below(2) == 0 ? static_cast<uint32_t>(random.below(64))
+                                            : static_cast<uint32_t>(random.next());
+    std::memcpy(image.data() + offset, &value, sizeof(value));
+    if (transcript) {
+        *transcript << "Image byte " << offset << " set to 0x" << std::hex << value << std::dec;
     }
+    try {
+        WorldTemplate corrupted(std::move(image));
+        if (transcript) *transcript << "; loaded" << std::endl;
+        return corrupted;
+    } catch (const std::runtime_error &e) {
+        if (transcript) *transcript << "; rejected: " << e.what() << "\n";
+        return std::nullopt;
+    }
+}
 
-    void add_npc(const NPC &npc) { npcs.push_back(npc); }
+struct FuzzFailure {
+    uint64_t seed;
+    size_t step;
+    std::string command;
+    std::string problem;
+};
 
-    NPC *find_npc(const std::string &npc_name) {
-        for (auto &npc : npcs) {
-            if (to_lowercase(npc.name) == to_lowercase(npc_name)) {
-                return &npc;
-            }
+// Plays one session; a failure is reported instead of a result. With a transcript stream, every
+// command and its output are written to it. A session started anywhere begins in a random room
+// holding every key, so that a few random commands reach the doors and chests deep in the world.
+std::optional<GameResult> fuzz_session(const WorldTemplate &world, const FuzzVocabulary &words,
+                                       uint64_t seed, size_t max_commands, uint64_t &commands,
+                                       FuzzFailure &failure, std::ostream *transcript = nullptr,
+                                       bool anywhere = false) {
+    FuzzRandom random(seed);
+    SessionArena arena;
+    Session session(world, arena.memory());
+    Output out(arena.memory());
+    if (anywhere) {
+        session.room_current = static_cast<RoomId>(random.below(world.rooms().size()));
+        for (const DoorRecord &door : world.doors()) {
+            if (door.required_key == NO_ITEM) continue;
+            session.player.player_inventory.push_back(door.required_key);
         }
-        return nullptr;
+        for (ItemId key : world.chest_keys()) session.player.player_inventory.push_back(key);
     }
-
-    bool remove_npc(const std::string &npc_name) {
-        auto i = std::remove_if(npcs.begin(), npcs.end(), [&](NPC &n) {
-            return to_lowercase(n.name) == to_lowercase(npc_name);
-        });
-        if (i != npcs.end()) {
-            npcs.erase(i, npcs.end());
-            return true;
+    begin_game(session, out);
+    std::string command;
+    for (size_t step = 0;; step++) {
+        std::optional<GameResult> result = prompt_action(session, out);
+        if (transcript) out.write_to(*transcript);
+        out.clear();
+        if (result) return result;
+        if (step == max_commands) return GameResult::EndOfInput;
+
+        command = fuzz_command(random, words, session);
+        if (transcript) *transcript << command << std::endl; // kept if the command crashes
+        std::string played = command;
+        bool was_alive = session.player.is_alive;
+        try {
+            commands++;
+            if (play_action(session, played, out) == Verb::Quit) return GameResult::Quit;
+        } catch (const std::exception &e) {
+            failure = FuzzFailure{seed, step, command, std::string("exception: ") + e.what()};
+            return std::nullopt;
+        }
+        std::string problem = check_session(session);
+        if (problem.empty() && was_alive && !session.player.is_alive) {
+            problem = check_death(session, played);
+        }
+        if (!problem.empty()) {
+            failure = FuzzFailure{seed, step, command, problem};
+            return std::nullopt;
         }
-        return false;
     }
-};
+}
 
-void attempt_move(Room *&room_current, const std::string &direction) {
-    Room *next_room = room_current->get_exit(direction);
-    if (!next_room) {
-        std::cout << "You can't go that way.\n\n";
-        return;
+// The seed of the session each thread is playing, for the crash handler to report
+thread_local uint64_t fuzz_current_seed = 0;
+
+extern "C" void report_fuzz_crash(int signal) {
+    char message[] = "\nCrashed in fuzz session 0x0000000000000000; replay with --fuzz-replay\n";
+    char *digits = std::strchr(message, 'x') + 1;
+    for (int i = 15; i >= 0; i--) {
+        digits[15 - i] = "0123456789abcdef"[(fuzz_current_seed >> (i * 4)) & 15];
     }
+    ssize_t written = ::write(STDERR_FILENO, message, sizeof(message) - 1);
+    (void)written;
+    std::signal(signal, SIG_DFL);
+    std::raise(signal);
+}
 
-    if (room_current->has_door(direction)) {
-        Door *door = room_current->get_door(direction);
-        if (door && door->is_locked()) {
-            std::cout << "The door is locked. Maybe there's a key nearby...\n\n";
-            return;
+int fuzz(const WorldTemplate &world, const std::vector<std::string> &args) {
+    unsigned threads = 0;
+    uint64_t sessions = 10000;
+    size_t max_commands = 200;
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    uint64_t seed = static_cast<uint64_t>(now.count());
+    std::optional<uint64_t> replay;
+    bool corrupt = false;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--corrupt-image") {
+            corrupt = true;
+            continue;
+        }
+        if (i + 1 == args.size()) {
+            std::cerr << args[i] << " needs a value\n";
+            return 1;
+        }
+        const std::string &value = args[++i];
+        if (args[i - 1] == "--fuzz") {
+            sessions = std::stoull(value);
+        } else if (args[i - 1] == "--fuzz-replay") {
+            replay = std::stoull(value, nullptr, 0);
+        } else if (args[i - 1] == "--threads") {
+            threads = static_cast<unsigned>(std::stoul(value));
+        } else if (args[i - 1] == "--commands") {
+            max_commands = std::stoul(value);
+        } else if (args[i - 1] == "--seed") {
+            seed = std::stoull(value, nullptr, 0);
+        } else {
+            std::cerr << "Unknown fuzz option " << args[i - 1] << "\n";
+            return 1;
         }
     }
 
-    room_current = next_room;
-    room_current->print_description();
-}
+    FuzzVocabulary words(world);
+    if (replay) {
+        std::optional<WorldTemplate> corrupted;
+        if (corrupt && !(corrupted = corrupt_world(world, *replay, &std::cout))) return 0;
+        uint64_t commands = 0;
+        FuzzFailure failure;
+        std::optional<GameResult> result =
+            fuzz_session(corrupted ? *corrupted : world, words, *replay, max_commands, commands,
+                         failure, &std::cout, corrupt);
+        if (!result) {
+            std::cout << "\nFAILED after " << failure.command << ": " << failure.problem << "\n";
+            return 1;
+        }
+        std::cout << "\nSession " << result_name(*result) << " after " << commands
+                  << " commands\n";
+        return 0;
+    }
 
-void try_open_door(Room *room_current, Player &player) {
-    for (auto &[direction, door] : room_current->doors) {
-        if (door.is_locked()) {
-            if (door.can_unlock(player.player_inventory)) {
-                std::cout << "You use the " << door.get_required_key()
-                          << " to unlock the door.\n\n";
-                door.unlock();
-                return; // unlock just one door at a time
+    for (int signal : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+        std::signal(signal, report_fuzz_crash);
+    }
+    threads = std::max(threads ? threads : std::thread::hardware_concurrency(), 1u);
+    std::atomic<uint64_t> next_session{0};
+    std::mutex mutex;
+    uint64_t total_commands = 0;
+    std::array<uint64_t, 4> outcomes{}; // indexed by GameResult
+    std::vector<FuzzFailure> failures;
+    std::atomic<uint64_t> rejected{0}; // corrupted images that did not load
+
+    auto started = std::chrono::steady_clock::now();
+    auto play = [&] {
+        uint64_t commands = 0;
+        std::array<uint64_t, 4> results{};
+        std::vector<FuzzFailure> failed;
+        for (uint64_t n; (n = next_session.fetch_add(1)) < sessions;) {
+            fuzz_current_seed = fuzz_session_seed(seed, n);
+            std::optional<WorldTemplate> corrupted;
+            if (corrupt && !(corrupted = corrupt_world(world, fuzz_current_seed, nullptr))) {
+                rejected.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            FuzzFailure failure;
+            std::optional<GameResult> result =
+                fuzz_session(corrupted ? *corrupted : world, words, fuzz_current_seed,
+                             max_commands, commands, failure, nullptr, corrupt);
+            if (result) {
+                results[static_cast<size_t>(*result)]++;
             } else {
-                std::cout << "The door is locked.\n\n";
-                return;
+                failed.push_back(std::move(failure));
             }
         }
+        std::lock_guard<std::mutex> lock(mutex);
+        total_commands += commands;
+        for (size_t i = 0; i < results.size(); i++) outcomes[i] += results[i];
+        failures.insert(failures.end(), failed.begin(), failed.end());
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; t++) workers.emplace_back(play);
+    play();
+    for (auto &worker : workers) worker.join();
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::cout << "Fuzzed " << sessions << " session(s) of up to " << max_commands
+              << " commands on " << threads << " thread(s), seed 0x" << std::hex << seed
+              << std::dec << "\n";
+    for (GameResult result :
+         {GameResult::Won, GameResult::Died, GameResult::Quit, GameResult::EndOfInput}) {
+        std::cout << "  " << std::left << std::setw(22) << result_name(result) << std::right
+                  << outcomes[static_cast<size_t>(result)] << "\n";
     }
-    std::cout << "There is no locked door here that you can open.\n\n";
-}
-
-void talk_to_npc(Room *room_current) {
-    if (!room_current->npcs.empty()) {
-        NPC *npc = &room_current->npcs[0]; // Always talk to the first NPC in the room
-        npc->talk();
-    } else {
-        std::cout << "There is no one to talk to...\n\n";
+    if (corrupt) {
+        std::cout << "  " << std::left << std::setw(22) << "image rejected" << std::right
+                  << rejected.load() << "\n";
+    }
+    std::cout << "  " << std::left << std::setw(22) << "failed" << std::right << failures.size()
+              << "\n"
+              << std::fixed << std::setprecision(1) << "\nSessions: " << sessions / seconds
+              << "/sec\nCommands: " << total_commands / seconds << "/sec\n\n"
+              << format_latency_table(*collect_metrics());
+
+    std::sort(failures.begin(), failures.end(),
+              [](const FuzzFailure &a, const FuzzFailure &b) { return a.seed < b.seed; });
+    for (size_t i = 0; i < failures.size() && i < 10; i++) {
+        std::cout << "\nFAILED session 0x" << std::hex << failures[i].seed << std::dec
+                  << " at command " << failures[i].step + 1 << " (" << failures[i].command
+                  << "): " << failures[i].problem;
     }
+    if (!failures.empty()) {
+        std::cout << "\nReplay one with --fuzz-replay <session>"
+                  << (corrupt ? " --corrupt-image\n" : "\n");
+    }
+    return failures.empty() ? 0 : 1;
 }
 
-void give_item_to_npc(Room *room_current, Player &player, const std::string &item_name) {
-    // Check for NPC in the room
-    if (room_current->npcs.empty()) {
-        std::cout << "There is no one to give the item to...\n\n";
-        return;
-    }
+// Server mode
+// One connection's game: the same coroutine as at the terminal, resumed as lines arrive. The
+// session and its arena are on the heap so that the coroutine's reference to them survives the
+// game being moved. A game started from a pinned world keeps that version until it ends, however
+// many times the world is reloaded meanwhile.
+class RemoteGame {
+public:
+    RemoteGame(const WorldTemplate &world, Output &out)
+        : arena(std::make_unique<SessionArena>()),
+          session(std::make_unique<Session>(world, arena->memory())),
+          game(welcome(*session, out)) {}
 
-    // Find the first NPC in the room
-    NPC *npc = &room_current->npcs[0];
-    if (!npc) {
-        std::cout << "There is no one to give an item to...\n\n";
-        return;
+    RemoteGame(Published<WorldTemplate>::Pin world, Output &out) : RemoteGame(*world, out) {
+        pin = std::move(world);
     }
 
-    // Give the required item
-    if (npc->required_item.empty()) {
-        std::cout << npc->name << " doesn't seem interested in anything you have.\n";
-        return;
+    bool on_line(std::string &line, Output &out) {
+        if (line.find_first_not_of(" \t\r\n\v\f") == std::string::npos) {
+            return true; // blank lines are skipped, as at the terminal
+        }
+        game.send(line, out);
+        return !game.done();
     }
 
-    // Find item in player's inventory
-    auto i = std::find_if(
-        player.player_inventory.begin(), player.player_inventory.end(),
-        [&](const Item &item) { return to_lowercase(item.item_name) == to_lowercase(item_name); });
+    std::string save() const { return session->save(); }
+    void load(std::string_view record) { session->load(record); }
 
-    if (i != player.player_inventory.end()) {
-        // Check if the item matches what the NPC wants
-        if (to_lowercase(i->item_name) == to_lowercase(npc->required_item)) {
-            npc->receive_item(*i);
-            player.player_inventory.erase(i);
-            std::cout << "You gave the " << item_name << " to " << npc->name << ".\n\n";
+    void describe(Output &out) {
+        session->tell_lost_language(out);
+        session->print_description(out);
+        out << "\nACTION: ";
+    }
 
-            if (!npc->post_receive_item_dialogue.empty()) {
-                std::cout << npc->post_receive_item_dialogue << "\n";
-            }
+private:
+    Published<WorldTemplate>::Pin pin; // declared first, so released last
+    std::unique_ptr<SessionArena> arena;
+    std::unique_ptr<Session> session;
+    LineTask<GameResult> game;
+};
 
-            if (npc->give_player_item != nullptr) {
-                std::cout << npc->name << " gives you a " << npc->give_player_item->item_name
-                          << ".\n\n";
-                player.add_to_inventory(*npc->give_player_item);
-                npc->give_player_item = nullptr;
-            }
+#ifdef __linux__
+int serve(const WorldTemplate &world, const std::string &world_path,
+          const std::vector<std::string> &args) {
+    ServerOptions options;
+    for (size_t i = 1; i < args.size(); i++) {
+        if (i + 1 == args.size()) {
+            std::cerr << args[i] << " needs a value\n";
+            return 1;
+        }
+        const std::string &value = args[++i];
+        if (args[i - 1] == "--tcp") {
+            size_t colon = value.rfind(':');
+            if (colon != std::string::npos) options.tcp_host = value.substr(0, colon);
+            options.tcp_port = std::stoi(value.substr(colon == std::string::npos ? 0 : colon + 1));
+        } else if (args[i - 1] == "--unix") {
+            options.unix_path = value;
+        } else if (args[i - 1] == "--threads") {
+            options.threads = static_cast<unsigned>(std::stoul(value));
+        } else if (args[i - 1] == "--hibernate-dir") {
+            options.hibernate_dir = value;
+        } else if (args[i - 1] == "--hibernate-after") {
+            options.hibernate_after = std::chrono::seconds(std::stoul(value));
+        } else if (args[i - 1] == "--journal-dir") {
+            options.journal_dir = value;
         } else {
-            std::cout << npc->name << " doesn't want that item.\n\n";
+            std::cerr << "Unknown server option " << args[i - 1] << "\n";
+            return 1;
         }
+    }
+    if (options.tcp_port < 0 && options.unix_path.empty()) {
+        options.tcp_port = 4000;
+    }
 
-        if (npc->can_be_killed_with_item(item_name)) {
-            npc->health = 0;
-            std::cout << npc->name << " falls to the ground and dies...\n\n";
-            room_current->remove_npc(npc->name);
-
-            if (npc->drop_item != nullptr) {
-                room_current->add_item(*npc->drop_item);
-                room_current->revealed_item_name = npc->drop_item->item_name;
-                room_current->has_been_searched = false;
-            }
+    // New games start in whatever world is current; SIGHUP reloads it from its file
+    Published<WorldTemplate> worlds(world);
+    auto reload = [&worlds, &world_path] {
+        if (world_path.empty()) {
+            std::cerr << "The built-in world cannot be reloaded; serve one with --world <file>\n";
+            return;
         }
-    } else {
-        std::cout << "You don't have that item...\n\n";
-    }
+        try {
+            WorldTemplate next = load_world(world_path);
+            warn_about_world(next);
+            uint64_t version = worlds.publish(std::move(next));
+            std::cerr << "Reloaded " << world_path << " as version " << version << "; "
+                      << worlds.versions() << " version(s) still in use\n";
+        } catch (const std::exception &e) {
+            std::cerr << "Could not reload " << world_path << ": " << e.what() << "\n";
+        }
+    };
+    Server<RemoteGame> server(
+        options, [&worlds](Output &out) { return RemoteGame(worlds.pin(), out); }, reload);
+    server.run();
+    return 0;
 }
-
-void attack_npc(Room *room_current, Player &player, const std::string &npc_name) {
-    NPC *npc = room_current->find_npc(npc_name);
-    if (npc) {
-        int max_damage = 1; // Default damage
-
-        for (const auto &item : player.player_inventory) {
-            if (item.item_name == "rusted knife") {
-                max_damage = std::max(max_damage, 2);
-            } else if (item.item_name == "obsidian dagger") {
-                max_damage = std::max(max_damage, 5);
-            }
+#else
+int serve(const WorldTemplate &, const std::string &, const std::vector<std::string> &) {
+    std::cerr << "--serve is only available on Linux\n";
+    return 1;
+}
+#endif
+
+// Scheduler benchmark
+// Plays one skewed load through the SessionScheduler twice, with sessions pinned to their home
+// worker as the server shards connections, and with work stealing. Every session plays a
+// script; the hot ones, every one homed on the first worker, first search their room over and
+// over, like a crowd of players in the same room. All lines are posted up front and the clock
+// runs until the last has run.
+int bench_scheduler(const WorldTemplate &world, const std::vector<std::string> &args) {
+    if (args.size() < 2) {
+        std::cerr << "--bench-scheduler needs a script\n";
+        return 1;
+    }
+    std::vector<Script> scripts;
+    if (!load_script(args[1], scripts)) return 1;
+    unsigned threads = 0;
+    size_t sessions = 256;
+    size_t hot_lines = 20000;
+    for (size_t i = 2; i < args.size(); i++) {
+        if (i + 1 == args.size()) {
+            std::cerr << args[i] << " needs a value\n";
+            return 1;
         }
-
-        npc->take_damage(max_damage);
-        int required_damage = 5;
-
-        if (max_damage >= required_damage) {
-            if (npc->health <= 0) {
-                if (npc->drop_item != nullptr) {
-                    room_current->add_item(*npc->drop_item);
-                    room_current->revealed_item_name = npc->drop_item->item_name;
-                    room_current->has_been_searched = false;
-                }
-                room_current->remove_npc(npc_name);
-            }
+        const std::string &value = args[++i];
+        if (args[i - 1] == "--threads") {
+            threads = static_cast<unsigned>(std::stoul(value));
+        } else if (args[i - 1] == "--sessions") {
+            sessions = std::stoul(value);
+        } else if (args[i - 1] == "--hot") {
+            hot_lines = std::stoul(value);
         } else {
-            std::cout << "The " << npc->name
-                      << " stands, and without hesitation...\nslices your throat.\n";
-            player.player_dies();
-            return;
+            std::cerr << "Unknown benchmark option " << args[i - 1] << "\n";
+            return 1;
         }
-    } else {
-        std::cout << "There is no one to attack..\n\n";
     }
+    threads = std::max(threads ? threads : std::thread::hardware_concurrency(), 2u);
+
+    std::vector<std::string> script;
+    std::istringstream commands(scripts[0].commands);
+    for (std::string line; std::getline(commands, line);) script.push_back(line);
+
+    std::cout << "Scheduling " << sessions << " sessions on " << threads << " workers; "
+              << (sessions + threads - 1) / threads << " hot sessions of "
+              << hot_lines + script.size() << " lines, the rest of " << script.size() << "\n\n";
+    for (Placement placement : {Placement::Static, Placement::Stealing}) {
+        SessionScheduler<RemoteGame> scheduler(threads, placement);
+        Output greeting;
+        for (size_t i = 0; i < sessions; i++) {
+            scheduler.add(RemoteGame(world, greeting));
+            greeting.clear();
+        }
+        auto started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < sessions; i++) {
+            if (i % threads == 0) {
+                for (size_t n = 0; n < hot_lines; n++) scheduler.post(i, "search");
+            }
+            for (const std::string &line : script) scheduler.post(i, line);
+        }
+        scheduler.drain();
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        uint64_t lines = 0, steals = 0, busiest = 0, idlest = UINT64_MAX;
+        for (const auto &worker : scheduler.stats()) {
+            lines += worker.lines;
+            steals += worker.steals;
+            busiest = std::max(busiest, worker.lines);
+            idlest = std::min(idlest, worker.lines);
+        }
+        std::cout << (placement == Placement::Static ? "Static sharding" : "Work stealing")
+                  << std::fixed << std::setprecision(3) << "\n  " << seconds << "s, "
+                  << std::setprecision(0) << lines / seconds << " lines/sec\n  lines per worker "
+                  << idlest << " to " << busiest << ", " << steals << " sessions stolen\n";
+    }
+    return 0;
 }
 
-bool check_victory(const Player &player) {
-    for (const auto &item : player.player_inventory) {
-        if (to_lowercase(item.item_name) == "orbis dei") {
-            std::cout << "\nYou feel an impossible weight settle in your "
-                         "hands...\nYou hear the heavens call upon you...\nThe ORBIS "
-                         "DEI hums with unknowable power...\nEverything "
-                         "fades...\nThanks for playing!!!\n\n";
-            return true;
-        }
+// World files
+// Problems do not stop a world from loading, since most of them only shut off part of it
+void warn_about_world(const WorldTemplate &world) {
+    for (const std::string &problem : validate_world(world)) {
+        std::cerr << "warning: " << problem << "\n";
     }
-    return false;
 }
 
-// Global items
-std::map<std::string, Item> item_library = {
-    {"rusted knife", Item("rusted knife", descriptions::ITEM_RUSTED_KNIFE)},
-    {"cell key", Item("cell key", descriptions::ITEM_CELL_KEY)},
-    {"room key", Item("room key", descriptions::ITEM_ROOM_KEY)},
-    {"blood-stained key", Item("blood-stained key", descriptions::ITEM_BLOODSTAINED_KEY)},
-    {"obsidian dagger", Item("obsidian dagger", descriptions::ITEM_OBSIDIAN_DAGGER)},
-    {"blood bottle", Item("blood bottle", descriptions::ITEM_BLOOD_BOTTLE)},
-    {"gold key", Item("gold key", descriptions::ITEM_GOLD_KEY)},
-    {"pater orbis", Item("pater orbis", descriptions::ITEM_PATER_ORBIS)},
-    {"mater orbis", Item("mater orbis", descriptions::ITEM_MATER_ORBIS)},
-    {"filius orbis", Item("filius orbis", descriptions::ITEM_FILIUS_ORBIS)},
-    {"ORBIS DEI", Item("ORBIS DEI", descriptions::ITEM_ORBIS_DEI)},
-    {"notes", Item("notes", descriptions::ITEM_NOTES)},
-    {"torn note", Item("torn note", descriptions::ITEM_TORN_NOTE)},
-    {"blood necklace", Item("blood necklace", descriptions::ITEM_BLOOD_NECKLACE)},
-    {"mother's heart", Item("mother's heart", descriptions::ITEM_MOTHERS_HEART)},
-    {"wooden sword", Item("wooden sword", descriptions::ITEM_WOODEN_SWORD)}};
+int check_world(const WorldTemplate &world) {
+    std::vector<std::string> problems = validate_world(world);
+    for (const std::string &problem : problems) std::cout << problem << "\n";
+    std::cout << problems.size() << " problem(s) found in " << world.rooms().size() << " rooms\n";
+    return problems.empty() ? 0 : 1;
+}
 
-// Functions
-void print_centered(const std::string &text, size_t width = 80) {
-    size_t pad = (width - text.length()) / 2;
-    if (pad > 0) std::cout << std::string(pad, ' ');
-    std::cout << text << '\n';
+int compile_world(const std::string &source, const std::string &image_path) {
+    std::ifstream in(source);
+    if (!in) {
+        std::cerr << "Could not open " << source << "\n";
+        return 1;
+    }
+    std::vector<char> image = WorldBuilder::parse(in, source).compile();
+    warn_about_world(WorldTemplate(image));
+    // Replaced rather than rewritten, as a server may have the old one mapped
+    if (!replace_file(image_path, image)) {
+        std::cerr << "Could not write " << image_path << "\n";
+        return 1;
+    }
+    std::cout << "Compiled " << source << " into " << image_path << " (" << image.size()
+              << " bytes)\n";
+    return 0;
 }
 
-std::string to_lowercase(const std::string &input) {
-    std::string result = input;
-    std::transform(result.begin(), result.end(), result.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
-    return result;
+int export_world(const std::string &path) {
+    WorldBuilder world;
+    build_world(world);
+    std::ofstream out(path);
+    world.write(out);
+    if (!out) {
+        std::cerr << "Could not write " << path << "\n";
+        return 1;
+    }
+    return 0;
 }
 
-std::string extract_direction(const std::string &input) {
-    std::vector<std::string> direction_words = {"north", "south", "east", "west"};
-    for (const auto &dir : direction_words) {
-        if (input.find(dir) != std::string::npos) {
-            return dir;
-        }
+int compile_locale_pack(const WorldTemplate &world, const std::string &source,
+                        const std::string &pack_path) {
+    std::ifstream in(source);
+    if (!in) {
+        std::cerr << "Could not open " << source << "\n";
+        return 1;
     }
-    return "";
+    std::vector<char> image = compile_locale(in, source, world);
+    if (!replace_file(pack_path, image)) {
+        std::cerr << "Could not write " << pack_path << "\n";
+        return 1;
+    }
+    std::cout << "Compiled " << source << " into " << pack_path << " (" << image.size()
+              << " bytes)\n";
+    return 0;
 }
 
-void start_new_game() {
-    std::cout << "\nInitializing TENEBRAE...\n\nYou wake up in dimly lit room...\n";
-
-    Room room_start(descriptions::ROOM_START, descriptions::SEARCH_START);
-    Room room_start_north(descriptions::ROOM_START_NORTH);
-    Room room_start_south(descriptions::ROOM_START_SOUTH, descriptions::SEARCH_SOUTH);
-    Room room_start_east(descriptions::ROOM_START_EAST, descriptions::SEARCH_EAST);
-    Room room_start_west(descriptions::ROOM_START_WEST);
-    Room room_start_northeast(descriptions::ROOM_START_NORTHEAST);
-    Room room_start_northwest(descriptions::ROOM_START_NORTHWEST);
-    Room room_start_southeast(descriptions::ROOM_START_SOUTHEAST);
-    Room room_start_southwest(descriptions::ROOM_START_SOUTHWEST);
-    Room room_prison_hallway_1(descriptions::ROOM_PRISON_HALLWAY_1);
-    Room room_prison_hallway_2(descriptions::ROOM_PRISON_HALLWAY_2);
-    Room room_prison_hallway_3(descriptions::ROOM_PRISON_HALLWAY_3);
-    Room room_prison_hallway_4(descriptions::ROOM_PRISON_HALLWAY_4,
-                               descriptions::SEARCH_PRISON_HALLWAY_4);
-    Room room_prison_hallway_5(descriptions::ROOM_PRISON_HALLWAY_5,
-                               descriptions::SEARCH_PRISON_HALLWAY_5);
-    Room room_prison_hallway_7(descriptions::ROOM_PRISON_HALLWAY_7);
-    Room room_prison_1_middle(descriptions::ROOM_PRISON_1_MIDDLE,
-                              descriptions::SEARCH_ROOM_PRISON_1_MIDDLE);
-    Room room_prison_1_north(descriptions::ROOM_PRISON_1_NORTH);
-    Room room_prison_1_south(descriptions::ROOM_PRISON_1_SOUTH);
-    Room room_prison_1_east(descriptions::ROOM_PRISON_1_EAST);
-    Room room_prison_1_west(descriptions::ROOM_PRISON_1_WEST,
-                            descriptions::SEARCH_ROOM_PRISON_1_WEST);
-    Room room_prison_1_northeast(descriptions::ROOM_PRISON_1_NORTHEAST);
-    Room room_prison_1_northwest(descriptions::ROOM_PRISON_1_NORTHWEST);
-    Room room_prison_1_southeast(descriptions::ROOM_PRISON_1_SOUTHEAST,
-                                 descriptions::SEARCH_ROOM_PRISON_1_SOUTHEAST);
-    Room room_prison_1_southwest(descriptions::ROOM_PRISON_1_SOUTHWEST);
-    Room room_prison_hallway_8(descriptions::ROOM_PRISON_HALLWAY_8);
-    Room room_prison_hallway_6(descriptions::ROOM_PRISON_HALLWAY_6);
-    Room room_prison_2_southeast(descriptions::ROOM_PRISON_2_SOUTHEAST);
-    Room room_prison_2_south(descriptions::ROOM_PRISON_2_SOUTH);
-    Room room_prison_2_southwest(descriptions::ROOM_PRISON_2_SOUTHWEST);
-    Room room_prison_2_middle(descriptions::ROOM_PRISON_2_MIDDLE);
-    Room room_prison_2_west(descriptions::ROOM_PRISON_2_WEST);
-    Room room_prison_2_east(descriptions::ROOM_PRISON_2_EAST);
-    Room room_prison_2_north(descriptions::ROOM_PRISON_2_NORTH,
-                             descriptions::SEARCH_ROOM_PRISON_2_NORTH);
-    Room room_prison_2_northwest(descriptions::ROOM_PRISON_2_NORTHWEST,
-                                 descriptions::SEARCH_ROOM_PRISON_2_NORTHWEST);
-    Room room_prison_2_northeast(descriptions::ROOM_PRISON_2_NORTHEAST,
-                                 descriptions::SEARCH_ROOM_PRISON_2_NORTHEAST);
-    Room room_storage_1(descriptions::ROOM_STORAGE_1, descriptions::SEARCH_ROOM_STORAGE_1);
-    Room room_prison_hallway_9(descriptions::ROOM_PRISON_HALLWAY_9);
-    Room room_prison_hallway_10(descriptions::ROOM_PRISON_HALLWAY_10);
-    Room room_prison_hallway_11(descriptions::ROOM_PRISON_HALLWAY_11);
-    Room room_prison_hallway_12(descriptions::ROOM_PRISON_HALLWAY_12);
-    Room room_cathedral_g1(descriptions::ROOM_CATHEDRAL_G1);
-    Room room_cathedral_g2(descriptions::ROOM_CATHEDRAL_G2);
-    Room room_cathedral_g3(descriptions::ROOM_CATHEDRAL_G3);
-    Room room_cathedral_g4(descriptions::ROOM_CATHEDRAL_G4);
-    Room room_cathedral_g5(descriptions::ROOM_CATHEDRAL_G5);
-    Room room_cathedral_g6(descriptions::ROOM_CATHEDRAL_G6);
-    Room room_cathedral_g7(descriptions::ROOM_CATHEDRAL_G7);
-    Room room_cathedral_g8(descriptions::ROOM_CATHEDRAL_G8);
-    Room room_cathedral_g9(descriptions::ROOM_CATHEDRAL_G9);
-    Room room_cathedral_g10(descriptions::ROOM_CATHEDRAL_G10,
-                            descriptions::SEARCH_ROOM_CATHEDRAL_G10);
-    Room room_cathedral_g11(descriptions::ROOM_CATHEDRAL_G11);
-    Room room_cathedral_g12(descriptions::ROOM_CATHEDRAL_G12);
-    Room room_cathedral_g13(descriptions::ROOM_CATHEDRAL_G13);
-    Room room_cathedral_g14(descriptions::ROOM_CATHEDRAL_G14);
-    Room room_cathedral_g15(descriptions::ROOM_CATHEDRAL_G15,
-                            descriptions::SEARCH_ROOM_CATHEDRAL_G15);
-    Room room_cathedral_g16(descriptions::ROOM_CATHEDRAL_G16);
-    Room room_cathedral_g17(descriptions::ROOM_CATHEDRAL_G17);
-    Room room_cathedral_g18(descriptions::ROOM_CATHEDRAL_G18);
-    Room room_cathedral_g19(descriptions::ROOM_CATHEDRAL_G19,
-                            descriptions::SEARCH_ROOM_CATHEDRAL_G19);
-    Room room_cathedral_g20(descriptions::ROOM_CATHEDRAL_G20);
-    Room room_cathedral_g21(descriptions::ROOM_CATHEDRAL_G21,
-                            descriptions::SEARCH_ROOM_CATHEDRAL_G21);
-    Room room_cathedral_g22(descriptions::ROOM_CATHEDRAL_G22);
-    Room room_brother_1_middle(descriptions::ROOM_BROTHER_1_MIDDLE);
-    Room room_brother_1_south(descriptions::ROOM_BROTHER_1_SOUTH);
-    Room room_brother_1_west(descriptions::ROOM_BROTHER_1_WEST);
-    Room room_brother_1_east(descriptions::ROOM_BROTHER_1_EAST);
-    Room room_brother_1_southeast(descriptions::ROOM_BROTHER_1_SOUTHEAST);
-    Room room_brother_1_southwest(descriptions::ROOM_BROTHER_1_SOUTHWEST);
-    Room room_brother_2_middle(descriptions::ROOM_BROTHER_2_MIDDLE);
-    Room room_brother_2_north(descriptions::ROOM_BROTHER_2_NORTH);
-    Room room_brother_2_south(descriptions::ROOM_BROTHER_2_SOUTH);
-    Room room_brother_2_east(descriptions::ROOM_BROTHER_2_EAST);
-    Room room_brother_2_northeast(descriptions::ROOM_BROTHER_2_NORTHEAST);
-    Room room_brother_2_southeast(descriptions::ROOM_BROTHER_2_SOUTHEAST);
-    Room room_brother_3_middle(descriptions::ROOM_BROTHER_3_MIDDLE);
-    Room room_brother_3_north(descriptions::ROOM_BROTHER_3_NORTH);
-    Room room_brother_3_south(descriptions::ROOM_BROTHER_3_SOUTH);
-    Room room_brother_3_west(descriptions::ROOM_BROTHER_3_WEST);
-    Room room_brother_3_northwest(descriptions::ROOM_BROTHER_3_NORTHWEST);
-    Room room_brother_3_southwest(descriptions::ROOM_BROTHER_3_SOUTHWEST);
-
-    // Starting Room Area Items, Doors, Chests
-    room_start_north.add_door("north", Door("cell key"));
-    room_start_south.revealed_item_name = "cell key";
-    room_start_east.revealed_item_name = "rusted knife";
-    room_start_south.add_item(item_library["cell key"]);
-    room_start_east.add_item(item_library["rusted knife"]);
-
-    // Starting Room Area
-    room_start.add_room_exit("north", &room_start_north);
-    room_start.add_room_exit("south", &room_start_south);
-    room_start.add_room_exit("east", &room_start_east);
-    room_start.add_room_exit("west", &room_start_west);
-    room_start_north.add_room_exit("south", &room_start);
-    room_start_north.add_room_exit("east", &room_start_northeast);
-    room_start_north.add_room_exit("west", &room_start_northwest);
-    room_start_northwest.add_room_exit("east", &room_start_north);
-    room_start_northwest.add_room_exit("south", &room_start_west);
-    room_start_northeast.add_room_exit("west", &room_start_north);
-    room_start_northeast.add_room_exit("south", &room_start_east);
-    room_start_north.add_room_exit("west", &room_start_northwest);
-    room_start_south.add_room_exit("north", &room_start);
-    room_start_south.add_room_exit("east", &room_start_southeast);
-    room_start_south.add_room_exit("west", &room_start_southwest);
-    room_start_southwest.add_room_exit("north", &room_start_west);
-    room_start_southwest.add_room_exit("east", &room_start_south);
-    room_start_southeast.add_room_exit("west", &room_start_south);
-    room_start_southeast.add_room_exit("north", &room_start_east);
-    room_start_west.add_room_exit("north", &room_start_northwest);
-    room_start_west.add_room_exit("east", &room_start);
-    room_start_west.add_room_exit("south", &room_start_southwest);
-    room_start_east.add_room_exit("west", &room_start);
-    room_start_east.add_room_exit("north", &room_start_northeast);
-    room_start_east.add_room_exit("south", &room_start_southeast);
-
-    // Prison Hallway Area
-    room_start_north.add_room_exit("north", &room_prison_hallway_1);
-    room_prison_hallway_1.add_room_exit("south", &room_start_north);
-    room_prison_hallway_1.add_room_exit("north", &room_prison_hallway_2);
-    room_prison_hallway_2.add_room_exit("south", &room_prison_hallway_1);
-    room_prison_hallway_2.add_room_exit("north", &room_prison_hallway_3);
-    room_prison_hallway_3.add_room_exit("south", &room_prison_hallway_2);
-    room_prison_hallway_3.add_room_exit("north", &room_prison_hallway_4);
-    room_prison_hallway_4.add_room_exit("south", &room_prison_hallway_3);
-    room_prison_hallway_4.add_room_exit("north", &room_prison_hallway_7);
-    room_prison_hallway_3.add_room_exit("west", &room_prison_hallway_5);
-    room_prison_hallway_5.add_room_exit("east", &room_prison_hallway_3);
-    room_prison_hallway_5.add_room_exit("west", &room_prison_hallway_6);
-    room_prison_hallway_6.add_room_exit("east", &room_prison_hallway_5);
-    room_prison_hallway_6.add_room_exit("west", &room_prison_2_southeast);
-    room_prison_hallway_7.add_room_exit("north", &room_prison_1_south);
-    room_prison_hallway_7.add_room_exit("south", &room_prison_hallway_4);
-    room_prison_hallway_8.add_room_exit("east", &room_prison_1_west);
-    room_prison_hallway_8.add_room_exit("west", &room_prison_hallway_9);
-    room_prison_hallway_9.add_room_exit("east", &room_prison_hallway_8);
-    room_prison_hallway_9.add_room_exit("west", &room_prison_hallway_10);
-    room_prison_hallway_10.add_room_exit("east", &room_prison_hallway_9);
-    room_prison_hallway_10.add_room_exit("north", &room_prison_hallway_11);
-    room_prison_hallway_11.add_room_exit("south", &room_prison_hallway_10);
-    room_prison_hallway_11.add_room_exit("north", &room_prison_hallway_12);
-    room_prison_hallway_12.add_room_exit("south", &room_prison_hallway_11);
-    room_prison_hallway_12.add_room_exit("north", &room_cathedral_g21);
-
-    // Items and Chests in Prison Room 1
-    Chest chest_pr_1(item_library["room key"]);
-    room_prison_1_southeast.add_chest(&chest_pr_1);
-
-    // NPC in Prison Room 1 (NORTH)
-    NPC masked_figure_1("Masked Figure",
-                        "A masked figure stands motionless. It watches you, and you can’t shake "
-                        "the sense it wants something...from you.\n",
-                        5, false, "blood bottle", "...", "blood bottle",
-                        "The masked figure lifts the blood bottle overhead and lets out a "
-                        "bone-chilling screech that echoes through the chamber.\nThe masked "
-                        "figure drinks the "
-                        "whole bottle...\n",
-                        &item_library["gold key"]);
-    room_prison_1_north.add_npc(masked_figure_1);
-
-    // Prison Room 1
-    room_prison_1_west.add_door("west", Door("gold key"));
-
-    room_prison_1_south.add_room_exit("south", &room_prison_hallway_7);
-    room_prison_1_south.add_room_exit("north", &room_prison_1_middle);
-    room_prison_1_south.add_room_exit("east", &room_prison_1_southeast);
-    room_prison_1_south.add_room_exit("west", &room_prison_1_southwest);
-    room_prison_1_middle.add_room_exit("south", &room_prison_1_south);
-    room_prison_1_middle.add_room_exit("east", &room_prison_1_east);
-    room_prison_1_middle.add_room_exit("west", &room_prison_1_west);
-    room_prison_1_middle.add_room_exit("north", &room_prison_1_north);
-    room_prison_1_north.add_room_exit("south", &room_prison_1_middle);
-    room_prison_1_north.add_room_exit("east", &room_prison_1_northeast);
-    room_prison_1_north.add_room_exit("west", &room_prison_1_northwest);
-    room_prison_1_west.add_room_exit("north", &room_prison_1_northwest);
-    room_prison_1_west.add_room_exit("east", &room_prison_1_middle);
-    room_prison_1_west.add_room_exit("south", &room_prison_1_southwest);
-    room_prison_1_east.add_room_exit("north", &room_prison_1_northeast);
-    room_prison_1_east.add_room_exit("west", &room_prison_1_middle);
-    room_prison_1_east.add_room_exit("south", &room_prison_1_southeast);
-    room_prison_1_northeast.add_room_exit("west", &room_prison_1_north);
-    room_prison_1_northeast.add_room_exit("south", &room_prison_1_east);
-    room_prison_1_northwest.add_room_exit("east", &room_prison_1_north);
-    room_prison_1_northwest.add_room_exit("south", &room_prison_1_west);
-    room_prison_1_southeast.add_room_exit("north", &room_prison_1_east);
-    room_prison_1_southeast.add_room_exit("west", &room_prison_1_south);
-    room_prison_1_southwest.add_room_exit("north", &room_prison_1_west);
-    room_prison_1_southwest.add_room_exit("east", &room_prison_1_south);
-    room_prison_1_west.add_room_exit("west", &room_prison_hallway_8);
-
-    // Items and Chests in Prison Room
-    room_prison_2_northeast.add_item(item_library["blood-stained key"]);
-    room_prison_2_northeast.revealed_item_name = "blood-stained key";
-    Chest chest_pr_2(item_library["obsidian dagger"], {"blood-stained key"});
-    room_prison_2_northwest.add_chest(&chest_pr_2);
-
-    // Prison Room 2, Torture Chamber
-    room_prison_hallway_6.add_door("west", Door("room key"));
-
-    room_prison_2_southeast.add_room_exit("east", &room_prison_hallway_6);
-    room_prison_2_southeast.add_room_exit("west", &room_prison_2_south);
-    room_prison_2_southeast.add_room_exit("north", &room_prison_2_east);
-    room_prison_2_southwest.add_room_exit("east", &room_prison_2_south);
-    room_prison_2_southwest.add_room_exit("north", &room_prison_2_west);
-    room_prison_2_south.add_room_exit("east", &room_prison_2_southeast);
-    room_prison_2_south.add_room_exit("north", &room_prison_2_middle);
-    room_prison_2_south.add_room_exit("west", &room_prison_2_southwest);
-    room_prison_2_middle.add_room_exit("south", &room_prison_2_south);
-    room_prison_2_middle.add_room_exit("east", &room_prison_2_east);
-    room_prison_2_middle.add_room_exit("west", &room_prison_2_west);
-    room_prison_2_middle.add_room_exit("north", &room_prison_2_north);
-    room_prison_2_north.add_room_exit("south", &room_prison_2_middle);
-    room_prison_2_north.add_room_exit("west", &room_prison_2_northwest);
-    room_prison_2_north.add_room_exit("east", &room_prison_2_northeast);
-    room_prison_2_northwest.add_room_exit("east", &room_prison_2_north);
-    room_prison_2_northwest.add_room_exit("south", &room_prison_2_west);
-    room_prison_2_northeast.add_room_exit("west", &room_prison_2_north);
-    room_prison_2_northeast.add_room_exit("south", &room_prison_2_east);
-    room_prison_2_west.add_room_exit("east", &room_prison_2_middle);
-    room_prison_2_west.add_room_exit("north", &room_prison_2_northwest);
-    room_prison_2_west.add_room_exit("south", &room_prison_2_southwest);
-    room_prison_2_east.add_room_exit("west", &room_prison_2_middle);
-    room_prison_2_east.add_room_exit("north", &room_prison_2_northeast);
-    room_prison_2_east.add_room_exit("south", &room_prison_2_southeast);
-
-    // Doors and Items in Room Storage 1
-    room_prison_2_southwest.add_door("west", Door("blood-stained key"));
-    room_storage_1.add_item(item_library["blood bottle"]);
-    room_storage_1.revealed_item_name = "blood bottle";
-
-    // Room Storage 1
-    room_prison_2_southwest.add_room_exit("west", &room_storage_1);
-    room_storage_1.add_room_exit("east", &room_prison_2_southwest);
-
-    // Doors and Items in Cathedral Room
-    room_prison_hallway_12.add_door("north", Door("gold key"));
-    room_cathedral_g6.add_door("west", Door("gold key"));
-    room_cathedral_g14.add_door("east", Door("gold key"));
-    room_cathedral_g1.add_door("north", Door("gold key"));
-    Chest chest_c1(item_library["ORBIS DEI"], {"pater orbis", "mater orbis", "filius orbis"});
-    room_cathedral_g10.add_chest(&chest_c1);
-    Chest chest_c2(item_library["mother's heart"]);
-    room_cathedral_g15.add_chest(&chest_c2);
-    Chest chest_c3(item_library["wooden sword"]);
-    room_cathedral_g19.add_chest(&chest_c3);
-
-    // NPCS
-    NPC masked_figure_2("Masked Figure", "A masked figure stands there motionless...", 5, false,
-                        "blood bottle", "The room named Filius contains the son...", "blood bottle",
-                        "The masked figure lifts the blood bottle overhead and lets out a "
-                        "bone-chilling screech that echoes through the chamber.\nThe masked "
-                        "figure drinks the whole bottle...\n",
-                        &item_library["notes"], nullptr);
-    room_cathedral_g6.add_npc(masked_figure_2);
-    NPC masked_figure_4("Masked Figure", "A masked figure stands there motionless...", 5, false,
-                        "blood bottle", "The room named Mater houses the mother...", "blood bottle",
-                        "The masked figure lifts the blood bottle overhead and lets out a "
-                        "bone-chilling screech that echoes through the chamber.\nThe masked "
-                        "figure drinks the whole bottle...\n",
-                        &item_library["torn note"], nullptr);
-    room_cathedral_g14.add_npc(masked_figure_4);
-    NPC masked_figure_3("Masked Figure", "A masked figure stands there motionless...", 5, false,
-                        "blood bottle", "WORSHIP THY PATER!", "blood bottle",
-                        "The masked figure lifts the blood bottle overhead and lets out a "
-                        "bone-chilling screech that echoes through the chamber.\nThe masked "
-                        "figure drinks the whole bottle...\n",
-                        nullptr, nullptr);
-    room_cathedral_g1.add_npc(masked_figure_3);
-    NPC masked_priest("Masked Priest",
-                      "The priest stands in silence, his white robes soaked through with "
-                      "blood. A gold mask hides his face. You see nothing in his eyes as they "
-                      "stare at you...\nYou also notice a necklace, with a blood vial dangling "
-                      "from his neck...\n",
-                      5, false, "blood bottle",
-                      "Pater Orbis - the eye that judges!\nMater Orbis - the heart that "
-                      "grieves!\nFilius Orbis - the hand that strikes!\nEach must be "
-                      "fed.\nOnly through blood does their silence speak.\nOnly through "
-                      "sacrifice, the cycle will be complete.",
-                      "blood bottle", "Yes. The sacred blood! Drink this with me my brothers!",
-                      &item_library["blood necklace"], nullptr);
-    room_cathedral_g10.add_npc(masked_priest);
-
-    // Cathedral Room
-    room_cathedral_g21.add_room_exit("south", &room_prison_hallway_12);
-    room_cathedral_g21.add_room_exit("west", &room_cathedral_g20);
-    room_cathedral_g21.add_room_exit("east", &room_cathedral_g22);
-    room_cathedral_g21.add_room_exit("north", &room_cathedral_g17);
-    room_cathedral_g20.add_room_exit("east", &room_cathedral_g21);
-    room_cathedral_g20.add_room_exit("north", &room_cathedral_g16);
-    room_cathedral_g22.add_room_exit("west", &room_cathedral_g21);
-    room_cathedral_g22.add_room_exit("north", &room_cathedral_g18);
-    room_cathedral_g17.add_room_exit("south", &room_cathedral_g21);
-    room_cathedral_g17.add_room_exit("west", &room_cathedral_g16);
-    room_cathedral_g17.add_room_exit("east", &room_cathedral_g18);
-    room_cathedral_g17.add_room_exit("north", &room_cathedral_g10);
-    room_cathedral_g16.add_room_exit("east", &room_cathedral_g17);
-    room_cathedral_g16.add_room_exit("west", &room_cathedral_g15);
-    room_cathedral_g16.add_room_exit("south", &room_cathedral_g20);
-    room_cathedral_g16.add_room_exit("north", &room_cathedral_g9);
-    room_cathedral_g15.add_room_exit("east", &room_cathedral_g16);
-    room_cathedral_g15.add_room_exit("north", &room_cathedral_g8);
-    room_cathedral_g18.add_room_exit("west", &room_cathedral_g17);
-    room_cathedral_g18.add_room_exit("east", &room_cathedral_g19);
-    room_cathedral_g18.add_room_exit("north", &room_cathedral_g11);
-    room_cathedral_g18.add_room_exit("south", &room_cathedral_g22);
-    room_cathedral_g19.add_room_exit("west", &room_cathedral_g18);
-    room_cathedral_g19.add_room_exit("north", &room_cathedral_g12);
-    room_cathedral_g10.add_room_exit("south", &room_cathedral_g17);
-    room_cathedral_g10.add_room_exit("west", &room_cathedral_g9);
-    room_cathedral_g10.add_room_exit("east", &room_cathedral_g11);
-    room_cathedral_g10.add_room_exit("north", &room_cathedral_g4);
-    room_cathedral_g9.add_room_exit("south", &room_cathedral_g16);
-    room_cathedral_g9.add_room_exit("east", &room_cathedral_g10);
-    room_cathedral_g9.add_room_exit("west", &room_cathedral_g8);
-    room_cathedral_g9.add_room_exit("north", &room_cathedral_g3);
-    room_cathedral_g8.add_room_exit("east", &room_cathedral_g9);
-    room_cathedral_g8.add_room_exit("west", &room_cathedral_g7);
-    room_cathedral_g8.add_room_exit("south", &room_cathedral_g15);
-    room_cathedral_g7.add_room_exit("east", &room_cathedral_g8);
-    room_cathedral_g7.add_room_exit("west", &room_cathedral_g6);
-    room_cathedral_g6.add_room_exit("east", &room_cathedral_g7);
-    room_cathedral_g11.add_room_exit("west", &room_cathedral_g10);
-    room_cathedral_g11.add_room_exit("east", &room_cathedral_g12);
-    room_cathedral_g11.add_room_exit("south", &room_cathedral_g18);
-    room_cathedral_g11.add_room_exit("north", &room_cathedral_g5);
-    room_cathedral_g12.add_room_exit("west", &room_cathedral_g11);
-    room_cathedral_g12.add_room_exit("east", &room_cathedral_g13);
-    room_cathedral_g12.add_room_exit("south", &room_cathedral_g19);
-    room_cathedral_g13.add_room_exit("west", &room_cathedral_g12);
-    room_cathedral_g13.add_room_exit("east", &room_cathedral_g14);
-    room_cathedral_g14.add_room_exit("west", &room_cathedral_g13);
-    room_cathedral_g4.add_room_exit("south", &room_cathedral_g10);
-    room_cathedral_g4.add_room_exit("east", &room_cathedral_g5);
-    room_cathedral_g4.add_room_exit("west", &room_cathedral_g3);
-    room_cathedral_g4.add_room_exit("north", &room_cathedral_g2);
-    room_cathedral_g3.add_room_exit("east", &room_cathedral_g4);
-    room_cathedral_g3.add_room_exit("south", &room_cathedral_g9);
-    room_cathedral_g5.add_room_exit("west", &room_cathedral_g4);
-    room_cathedral_g5.add_room_exit("south", &room_cathedral_g11);
-    room_cathedral_g2.add_room_exit("south", &room_cathedral_g4);
-    room_cathedral_g2.add_room_exit("north", &room_cathedral_g1);
-    room_cathedral_g1.add_room_exit("south", &room_cathedral_g2);
-    room_cathedral_g6.add_room_exit("west", &room_brother_2_east);
-    room_cathedral_g1.add_room_exit("north", &room_brother_1_south);
-    room_cathedral_g14.add_room_exit("east", &room_brother_3_west);
-
-    // Room 2
-
-    // NPC
-
-    NPC filius("The son", "The son sits in the middle of his room, looking for something...\n", 5,
-               false, "wooden sword",
-               "Please help me, I've lost my wooden sword! If you find it, I can give "
-               "you something in return.",
-               "", "That's it! Here you can have this.", &item_library["filius orbis"],
-               &item_library["filius orbis"]);
-    room_brother_2_middle.add_npc(filius);
-
-    room_brother_2_east.add_room_exit("east", &room_cathedral_g6);
-    room_brother_2_east.add_room_exit("north", &room_brother_2_northeast);
-    room_brother_2_east.add_room_exit("south", &room_brother_2_southeast);
-    room_brother_2_east.add_room_exit("west", &room_brother_2_middle);
-    room_brother_2_northeast.add_room_exit("south", &room_brother_2_east);
-    room_brother_2_northeast.add_room_exit("west", &room_brother_2_north);
-    room_brother_2_southeast.add_room_exit("north", &room_brother_2_east);
-    room_brother_2_southeast.add_room_exit("west", &room_brother_2_south);
-    room_brother_2_middle.add_room_exit("east", &room_brother_2_east);
-    room_brother_2_middle.add_room_exit("north", &room_brother_2_north);
-    room_brother_2_middle.add_room_exit("south", &room_brother_2_south);
-    room_brother_2_south.add_room_exit("north", &room_brother_2_middle);
-    room_brother_2_south.add_room_exit("east", &room_brother_2_southeast);
-    room_brother_2_north.add_room_exit("east", &room_brother_2_northeast);
-    room_brother_2_north.add_room_exit("south", &room_brother_2_middle);
-
-    // Room 3
-
-    // NPC
-    NPC mater("The mother", "The mother sits in the middle of the room, painting something...\n", 5,
-              false, "mother's heart",
-              "Don't speak to me while I'm painting...\nComeback once you've got "
-              "something worthwhile...",
-              "",
-              "Oh...that's my old project.\nI've taken my heart and sacrificed "
-              "it to our savior!\nYou should try it sometime...",
-              &item_library["mater orbis"], &item_library["mater orbis"]);
-    room_brother_3_middle.add_npc(mater);
-
-    room_brother_3_west.add_room_exit("west", &room_cathedral_g14);
-    room_brother_3_west.add_room_exit("north", &room_brother_3_northwest);
-    room_brother_3_west.add_room_exit("south", &room_brother_3_southwest);
-    room_brother_3_west.add_room_exit("east", &room_brother_3_middle);
-    room_brother_3_southwest.add_room_exit("north", &room_brother_3_west);
-    room_brother_3_southwest.add_room_exit("east", &room_brother_3_south);
-    room_brother_3_south.add_room_exit("west", &room_brother_3_southwest);
-    room_brother_3_south.add_room_exit("north", &room_brother_3_middle);
-    room_brother_3_middle.add_room_exit("west", &room_brother_3_west);
-    room_brother_3_middle.add_room_exit("north", &room_brother_3_north);
-    room_brother_3_middle.add_room_exit("south", &room_brother_3_south);
-    room_brother_3_northwest.add_room_exit("south", &room_brother_3_west);
-    room_brother_3_northwest.add_room_exit("east", &room_brother_3_north);
-    room_brother_3_north.add_room_exit("west", &room_brother_3_northwest);
-    room_brother_3_north.add_room_exit("south", &room_brother_3_middle);
-
-    // Room 1
-
-    // NPC
-    NPC pater("The father", "The father sits upon a throne of blood...\n", 5, false,
-              "blood necklace",
-              "Someone stole my blood necklace...\nWhen I find out who did it, "
-              "I'm going to tear their head out of their fleshed body!",
-              "",
-              "You've found it...who had it???\nWas it the priest?\nNo matter, "
-              "here take this and start your ascent...",
-              &item_library["pater orbis"], &item_library["pater orbis"]);
-    room_brother_1_middle.add_npc(pater);
-
-    room_brother_1_south.add_room_exit("south", &room_cathedral_g1);
-    room_brother_1_south.add_room_exit("west", &room_brother_1_southwest);
-    room_brother_1_south.add_room_exit("east", &room_brother_1_southeast);
-    room_brother_1_south.add_room_exit("north", &room_brother_1_middle);
-    room_brother_1_southwest.add_room_exit("east", &room_brother_1_south);
-    room_brother_1_southwest.add_room_exit("north", &room_brother_1_west);
-    room_brother_1_southeast.add_room_exit("west", &room_brother_1_south);
-    room_brother_1_southeast.add_room_exit("north", &room_brother_1_east);
-    room_brother_1_middle.add_room_exit("south", &room_brother_1_south);
-    room_brother_1_middle.add_room_exit("west", &room_brother_1_west);
-    room_brother_1_middle.add_room_exit("east", &room_brother_1_east);
-    room_brother_1_west.add_room_exit("east", &room_brother_1_middle);
-    room_brother_1_west.add_room_exit("south", &room_brother_1_southwest);
-    room_brother_1_east.add_room_exit("west", &room_brother_1_middle);
-    room_brother_1_east.add_room_exit("south", &room_brother_1_southeast);
-
-    // Player's current Room
-    Room *room_current = &room_start;
-    Player player;
-
-    room_current->print_description();
-
-    std::string player_action;
+int export_locale_file(const WorldTemplate &world, const std::string &path) {
+    std::ofstream out(path);
+    export_locale(world, out);
+    if (!out) {
+        std::cerr << "Could not write " << path << "\n";
+        return 1;
+    }
+    return 0;
+}
 
-    while (true) {
-        if (!player.is_alive) {
-            std::cout << "\nYou died...\n";
-            break;
+void print_usage(const char *program) {
+    std::cerr << "Usage: " << program
+              << " [--world <file>] [--headless <script|directory> [--repeat N]]\n"
+              << "       " << program
+              << " [--world <file>] --serve [--tcp [host:]port] [--unix path] [--threads N]\n"
+              << "       " << std::string(std::strlen(program), ' ')
+              << "   [--hibernate-dir <directory>] [--hibernate-after seconds]\n"
+              << "       " << std::string(std::strlen(program), ' ')
+              << "   [--journal-dir <directory>]\n"
+              << "       " << program << " [--world <file>] --solve [--threads N]\n"
+              << "       " << program << " [--world <file>] --check-world\n"
+              << "       " << program
+              << " [--world <file>] --fuzz <sessions> [--threads N] [--commands N] [--seed S]\n"
+              << "       " << std::string(std::strlen(program), ' ') << "   [--corrupt-image]\n"
+              << "       " << program
+              << " [--world <file>] --fuzz-replay <session> [--commands N] [--corrupt-image]\n"
+              << "       " << program
+              << " [--world <file>] --bench-scheduler <script> [--threads N]\n"
+              << "       " << std::string(std::strlen(program), ' ')
+              << "   [--sessions N] [--hot N]\n"
+              << "       " << program << " --compile-world <definition file> <image file>\n"
+              << "       " << program << " --export-world <definition file>\n"
+              << "       " << program << " [--world <file>] --export-locale <definition file>\n"
+              << "       " << program
+              << " [--world <file>] --compile-locale <definition file> <pack file>\n"
+              << "Add --stats-file <file> before the mode to have per-verb latency written to\n"
+              << "that file every second, and --locale-dir <directory> to let players switch to\n"
+              << "the locale packs (*.tlp) in it.\n";
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    std::string world_path;
+    std::string stats_path;
+    std::string locale_dir;
+    while (args.size() >= 2 &&
+           (args[0] == "--world" || args[0] == "--stats-file" || args[0] == "--locale-dir")) {
+        (args[0] == "--world" ? world_path : args[0] == "--stats-file" ? stats_path : locale_dir) =
+            args[1];
+        args.erase(args.begin(), args.begin() + 2);
+    }
+    std::optional<StatsReporter> reporter;
+    if (!stats_path.empty()) reporter.emplace(stats_path, std::chrono::seconds(1));
+
+    try {
+        if (args.size() == 3 && args[0] == "--compile-world") {
+            return compile_world(args[1], args[2]);
         }
-        if (check_victory(player)) {
-            break;
+        if (args.size() == 2 && args[0] == "--export-world") {
+            return export_world(args[1]);
         }
 
-        std::cout << "\nACTION: ";
-        std::getline(std::cin >> std::ws, player_action);
-        player_action = to_lowercase(player_action);
-        std::cout << "\n";
-
-        if (player_action.find("search") != std::string::npos ||
-            player_action.find("find") != std::string::npos ||
-            player_action.find("look") != std::string::npos) {
-            room_current->print_search_description();
-
-        } else if (player_action.find("take") != std::string::npos) {
-            if (room_current->has_been_searched_by_player() &&
-                !room_current->revealed_item_name.empty()) {
-                Item *item = room_current->find_item(room_current->revealed_item_name);
-                if (item) {
-                    player.add_to_inventory(*item);
-                    room_current->remove_item(item->item_name);
-                    room_current->revealed_item_name.clear(); // prevent double-take
-                } else {
-                    std::cout << "The item is no longer here.\n";
-                }
-            } else {
-                std::cout << "You see nothing to take.\nTry searching first...\n\n";
+        WorldTemplate world = world_path.empty() ? builtin_world() : load_world(world_path);
+        if (args.size() == 1 && args[0] == "--check-world") {
+            return check_world(world);
+        }
+        warn_about_world(world);
+        if (!locale_dir.empty()) locale_shelf().load_directory(locale_dir, world, std::cerr);
+
+        if (!args.empty()) {
+            if (args[0] == "--headless" &&
+                (args.size() == 2 || (args.size() == 4 && args[2] == "--repeat"))) {
+                return run_headless(world, args[1], args.size() == 4 ? std::stoi(args[3]) : 1);
             }
-        } else if (player_action.find("inventory") != std::string::npos) {
-            player.print_inventory();
-
-        } else if (player_action.find("open") != std::string::npos ||
-                   player_action.find("use key") != std::string::npos) {
-            if (room_current->chest && !room_current->chest->is_opened()) {
-                if (room_current->chest->is_locked()) {
-                    if (room_current->chest->can_unlock(player.player_inventory)) {
-                        std::cout << "You unlock the chest using the "
-                                  << room_current->chest->get_required_key() << ".\n\n";
-                        room_current->chest->unlock();
-                    } else {
-                        std::cout << "The chest is locked.\n\n";
-                        continue;
-                    }
-                }
-                Item found_item = room_current->chest->open();
-                std::cout << "You open the chest and found... " << found_item.item_name << "!\n\n";
-                player.add_to_inventory(found_item);
-                if (check_victory(player)) {
-                    break;
-                };
-            } else {
-                try_open_door(room_current, player);
+            if (args[0] == "--solve" &&
+                (args.size() == 1 || (args.size() == 3 && args[1] == "--threads"))) {
+                unsigned long threads = args.size() == 3 ? std::stoul(args[2]) : 0;
+                return solve(world, static_cast<unsigned>(threads));
             }
-
-        } else if (!extract_direction(player_action).empty()) {
-            std::string dir = extract_direction(player_action);
-            attempt_move(room_current, dir);
-
-        } else if (player_action.find("talk") != std::string::npos ||
-                   player_action.find("ask") != std::string::npos) {
-            talk_to_npc(room_current);
-
-        } else if (player_action.find("give") != std::string::npos) {
-            size_t item_position = player_action.find(" ");
-
-            if (item_position != std::string::npos) {
-                std::string item_name =
-                    player_action.substr(item_position + 1); // Extract item position
-                give_item_to_npc(room_current, player, item_name);
-            } else {
-                std::cout << "Give what?\n";
+            if (args[0] == "--serve") {
+                return serve(world, world_path, args);
             }
-
-        } else if (player_action.find("kill self") != std::string::npos ||
-                   player_action.find("kill myself") != std::string::npos ||
-                   player_action.find("suicide") != std::string::npos) {
-            if (player.has_item("rusted knife")) {
-                std::cout << "You can't handle the darkness...\nYou take the rusted "
-                             "knife and plunge it deep into stomach...\n";
-                player.player_dies();
-            } else if (player.has_item("obsidian dagger")) {
-                std::cout << "The dagger speaks to you...\nIt wants you...\nYou hear "
-                             "the voices that come before...\nYou look to the ceiling "
-                             "and plunge the dagger into your stomach...\n";
-                player.player_dies();
-            } else {
-                std::cout << "You have nothing to kill yourself with...\n";
+            if (args[0] == "--fuzz" || args[0] == "--fuzz-replay") {
+                return fuzz(world, args);
             }
-
-        } else if (player_action.find("attack") != std::string::npos ||
-                   player_action.find("kill") != std::string::npos) {
-            if (!room_current->npcs.empty()) {
-                std::string npc_name =
-                    room_current->npcs[0].name; // Get the name of the first NPC in the room
-                attack_npc(room_current, player, npc_name);
-            } else {
-                std::cout << "There is no one to attack...\n";
+            if (args[0] == "--bench-scheduler") {
+                return bench_scheduler(world, args);
             }
-
-        } else if (player_action.find("drink blood bottle") != std::string::npos) {
-            if (player.has_item("blood bottle")) {
-                std::cout << "You begin to drink the blood bottle...\nYou feel the thick "
-                             "coagulated blood slide down your throat...\nAt first your body "
-                             "wanted to reject it, but after you drink...\nand drink...\nand "
-                             "drink...\nYou begin to feel something else...\nBliss...\n";
-                player.player_dies();
-
-            } else {
-                std::cout << "You don't have a blood bottle in your inventory.\n\n";
+            if (args.size() == 2 && args[0] == "--export-locale") {
+                return export_locale_file(world, args[1]);
             }
-        } else if (player_action == "quit" || player_action == "exit" ||
-                   player_action == "quit game") {
-            std::cout << "You decide it's time to stop. Returning to the Main "
-                         "Menu.\n";
-            break;
-
-        } else {
-            std::cout << "You can't do that right now. \nTry search, "
-                         "inventory, north, south, east, west, or quit\n\n";
+            if (args.size() == 3 && args[0] == "--compile-locale") {
+                return compile_locale_pack(world, args[1], args[2]);
+            }
+            print_usage(argv[0]);
+            return 1;
         }
-    }
-}
 
-void show_menu() {
-    std::cout << "\n\n";
-    print_centered("<============================>");
-    print_centered("TENEBRAE");
-    print_centered("Main Menu");
-    std::cout << "\n";
-    print_centered("    [1] New Game      ");
-    print_centered("    [2] Quit          ");
-    std::cout << "\n";
-    print_centered("Enter [1] or [2]");
-    print_centered(" <============================>\n");
-}
-
-void quit_game(bool &game_running) {
-    std::cout << "\nQuitting...\n";
-    game_running = false;
-}
-
-int main() {
-    int menu_choice{};
-    bool game_running{true};
-
-    while (game_running) {
-        show_menu();
-        std::cout << "ACTION: ";
-        if (!(std::cin >> menu_choice)) {
-            std::cin.clear();
-            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            std::cout << "Invalid input. Please enter 1 OR 2.\n";
-            continue;
-        }
-        switch (menu_choice) {
-        case 1:
-            start_new_game();
-            break;
-        case 2:
-            quit_game(game_running);
-            break;
-        default:
-            std::cout << "Invalid choice\n";
+        int menu_choice{};
+        bool game_running{true};
+
+        while (game_running) {
+            show_menu();
+            std::cout << "ACTION: ";
+            if (!(std::cin >> menu_choice)) {
+                if (std::cin.eof()) break;
+                std::cin.clear();
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                std::cout << "Invalid input. Please enter 1 OR 2.\n";
+                continue;
+            }
+            switch (menu_choice) {
+            case 1:
+                start_new_game(world, std::cin, std::cout);
+                break;
+            case 2:
+                quit_game(game_running);
+                break;
+            default:
+                std::cout << "Invalid choice\n";
+            }
         }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
     }
 }
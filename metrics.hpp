@@ -0,0 +1,258 @@
+#pragma once
+
+#include "command.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Per-verb command latency. Each thread records into its own shard of plain counters, so the
+// game loop never shares a cache line or takes a lock; collect_metrics() merges the shards,
+// either when asked for (the stats command) or every interval from a StatsReporter thread
+// that writes a scrape file.
+//
+// Latencies go into HDR-style log-linear histograms: values below 64ns get a bucket each, and
+// every power of two above that is split into 32 buckets, so a percentile read back is within
+// about 3% of the true value. Latencies above LATENCY_MAX_NS count as LATENCY_MAX_NS.
+
+constexpr unsigned LATENCY_SUB_BITS = 5;
+constexpr uint64_t LATENCY_SUB_BUCKETS = uint64_t{1} << LATENCY_SUB_BITS;
+constexpr unsigned LATENCY_MAX_BITS = 36;
+constexpr uint64_t LATENCY_MAX_NS = (uint64_t{1} << LATENCY_MAX_BITS) - 1; // about 68s
+constexpr size_t LATENCY_BUCKETS =
+    2 * LATENCY_SUB_BUCKETS + (LATENCY_MAX_BITS - LATENCY_SUB_BITS - 1) * LATENCY_SUB_BUCKETS;
+
+constexpr size_t latency_bucket(uint64_t ns) {
+    ns = std::min(ns, LATENCY_MAX_NS);
+    if (ns < 2 * LATENCY_SUB_BUCKETS) return static_cast<size_t>(ns);
+    unsigned shift = static_cast<unsigned>(std::bit_width(ns)) - LATENCY_SUB_BITS - 1;
+    return shift * LATENCY_SUB_BUCKETS + static_cast<size_t>(ns >> shift);
+}
+
+// Largest latency that falls in a bucket
+constexpr uint64_t latency_bucket_high(size_t bucket) {
+    if (bucket < 2 * LATENCY_SUB_BUCKETS) return bucket;
+    uint64_t shift = bucket / LATENCY_SUB_BUCKETS - 1;
+    uint64_t top = bucket - shift * LATENCY_SUB_BUCKETS;
+    return ((top + 1) << shift) - 1;
+}
+
+static_assert(latency_bucket(LATENCY_MAX_NS) == LATENCY_BUCKETS - 1);
+static_assert(latency_bucket(latency_bucket_high(1000)) == 1000);
+static_assert(latency_bucket(latency_bucket_high(1000) + 1) == 1001);
+
+struct LatencyHistogram {
+    std::array<uint64_t, LATENCY_BUCKETS> counts{};
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+
+    // Smallest latency at least `quantile` of the calls took no longer than
+    uint64_t percentile(double quantile) const {
+        if (count == 0) return 0;
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(quantile * count + 0.5));
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+            seen += counts[bucket];
+            if (seen >= rank) return std::min(latency_bucket_high(bucket), max_ns);
+        }
+        return max_ns;
+    }
+
+    double mean_ns() const { return count ? static_cast<double>(total_ns) / count : 0.0; }
+};
+
+using VerbLatencies = std::array<LatencyHistogram, VERB_COUNT>;
+
+// One thread's counters. Only that thread writes them, so relaxed loads and stores are enough;
+// they are atomic only so that collect_metrics() can read them while they change.
+class MetricsShard {
+public:
+    void record(Verb verb, std::chrono::nanoseconds elapsed) {
+        uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 0));
+        Histogram &histogram = verbs[static_cast<size_t>(verb)];
+        bump(histogram.counts[latency_bucket(ns)], 1);
+        bump(histogram.total_ns, ns);
+        if (ns > histogram.max_ns.load(std::memory_order_relaxed)) {
+            histogram.max_ns.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    void add_to(VerbLatencies &latencies) const {
+        for (size_t v = 0; v < VERB_COUNT; v++) {
+            const Histogram &from = verbs[v];
+            LatencyHistogram &to = latencies[v];
+            for (size_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+                uint64_t count = from.counts[bucket].load(std::memory_order_relaxed);
+                to.counts[bucket] += count;
+                to.count += count;
+            }
+            to.total_ns += from.total_ns.load(std::memory_order_relaxed);
+            to.max_ns = std::max(to.max_ns, from.max_ns.load(std::memory_order_relaxed));
+        }
+    }
+
+private:
+    struct Histogram {
+        std::array<std::atomic<uint64_t>, LATENCY_BUCKETS> counts{};
+        std::atomic<uint64_t> total_ns{0};
+        std::atomic<uint64_t> max_ns{0};
+    };
+
+    Histogram verbs[VERB_COUNT];
+
+    static void bump(std::atomic<uint64_t> &counter, uint64_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount,
+                      std::memory_order_relaxed);
+    }
+};
+
+// Every shard created so far. Shards outlive their threads, so nothing recorded is lost, and one
+// whose thread has exited is handed to the next new thread: there are never more shards than
+// threads that were alive at once, however many threads a host starts and stops.
+struct MetricsRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<MetricsShard>> shards;
+    std::vector<MetricsShard *> unused;
+};
+
+inline MetricsRegistry &metrics_registry() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+// A thread's hold on its shard, taken the first time it records and given back when it exits
+class MetricsShardLease {
+public:
+    MetricsShardLease() {
+        MetricsRegistry &registry = metrics_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (registry.unused.empty()) {
+            registry.shards.push_back(std::make_unique<MetricsShard>());
+            shard = registry.shards.back().get();
+        } else {
+            shard = registry.unused.back();
+            registry.unused.pop_back();
+        }
+    }
+
+    MetricsShardLease(const MetricsShardLease &) = delete;
+    MetricsShardLease &operator=(const MetricsShardLease &) = delete;
+
+    ~MetricsShardLease() {
+        MetricsRegistry &registry = metrics_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.unused.push_back(shard);
+    }
+
+    MetricsShard &get() const { return *shard; }
+
+private:
+    MetricsShard *shard;
+};
+
+// The calling thread's shard
+inline MetricsShard &local_metrics() {
+    thread_local MetricsShardLease lease;
+    return lease.get();
+}
+
+// Every thread's latencies since the process started; on the heap, as it is over 100KB
+inline std::unique_ptr<VerbLatencies> collect_metrics() {
+    auto latencies = std::make_unique<VerbLatencies>();
+    MetricsRegistry &registry = metrics_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const auto &shard : registry.shards) shard->add_to(*latencies);
+    return latencies;
+}
+
+// Verbs that were used, one per line with their count, mean, p50, p99 and max in nanoseconds
+inline std::string format_latency_table(const VerbLatencies &latencies) {
+    std::ostringstream out;
+    out << std::left << std::setw(12) << "Verb" << std::right << std::setw(12) << "Count"
+        << std::setw(14) << "Mean (ns)" << std::setw(12) << "p50 (ns)" << std::setw(12)
+        << "p99 (ns)" << std::setw(14) << "Max (ns)" << "\n"
+        << std::fixed << std::setprecision(1);
+    for (size_t v = 0; v < VERB_COUNT; v++) {
+        const LatencyHistogram &histogram = latencies[v];
+        if (histogram.count == 0) continue;
+        out << std::left << std::setw(12) << VERB_NAMES[v] << std::right << std::setw(12)
+            << histogram.count << std::setw(14) << histogram.mean_ns() << std::setw(12)
+            << histogram.percentile(0.5) << std::setw(12) << histogram.percentile(0.99)
+            << std::setw(14) << histogram.max_ns << "\n";
+    }
+    return out.str();
+}
+
+// Plain-text exposition format, one sample per line
+inline std::string format_latency_scrape(const VerbLatencies &latencies) {
+    std::ostringstream out;
+    out << "# Tenebrae command latency per verb since startup, in nanoseconds\n";
+    for (size_t v = 0; v < VERB_COUNT; v++) {
+        const LatencyHistogram &histogram = latencies[v];
+        std::string label = std::string("{verb=\"") + VERB_NAMES[v] + "\"";
+        out << "tenebrae_commands_total" << label << "} " << histogram.count << "\n";
+        for (double quantile : {0.5, 0.9, 0.99, 0.999}) {
+            out << "tenebrae_command_latency_ns" << label << ",quantile=\"" << quantile << "\"} "
+                << histogram.percentile(quantile) << "\n";
+        }
+        out << "tenebrae_command_latency_ns_sum" << label << "} " << histogram.total_ns << "\n";
+        out << "tenebrae_command_latency_ns_max" << label << "} " << histogram.max_ns << "\n";
+    }
+    return out.str();
+}
+
+// Merges every shard each interval and replaces the scrape file by renaming a fully written
+// temporary file over it, so readers see the old figures or the new, never half of either
+class StatsReporter {
+public:
+    StatsReporter(std::string path, std::chrono::milliseconds interval)
+        : path(std::move(path)), interval(interval), thread([this] { run(); }) {}
+
+    ~StatsReporter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
+
+private:
+    std::string path;
+    std::chrono::milliseconds interval;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread thread;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            bool stop = wake.wait_for(lock, interval, [this] { return stopping; });
+            write(); // once more when stopping, so the file ends up complete
+            if (stop) return;
+        }
+    }
+
+    void write() const {
+        std::string text = format_latency_scrape(*collect_metrics());
+        std::string temporary = path + ".tmp";
+        std::ofstream file(temporary, std::ios::trunc);
+        file << text;
+        file.close();
+        if (file) std::rename(temporary.c_str(), path.c_str());
+    }
+};
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "world.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <sys/uio.h>
+#include <type_traits>
+#include <vector>
+
+// Everything a session prints for one command, sent with a single writev. String literals and
+// world text are kept by reference; anything else (player input, numbers, built strings) is
+// copied into the buffer. Short static pieces are copied too, since an iovec entry costs more
+// than copying a few bytes. Its buffers come from the given memory resource, and are kept from one
+// command to the next.
+class Output {
+public:
+    static constexpr size_t COPY_BELOW = 64;
+
+    explicit Output(std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+        : segments(memory), copied(memory) {}
+
+    template <size_t N> Output &operator<<(const char (&literal)[N]) {
+        add_static(literal, N - 1);
+        return *this;
+    }
+
+    Output &operator<<(Text text) {
+        add_static(text.data(), text.size());
+        return *this;
+    }
+
+    Output &operator<<(std::string_view text) {
+        copy(text.data(), text.size());
+        return *this;
+    }
+
+    Output &operator<<(char c) {
+        copy(&c, 1);
+        return *this;
+    }
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    Output &operator<<(T value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        copy(digits, static_cast<size_t>(result.ptr - digits));
+        return *this;
+    }
+
+    // Bytes not sent yet
+    size_t size() const { return total - sent; }
+    bool empty() const { return size() == 0; }
+
+    void clear() {
+        segments.clear();
+        copied.clear();
+        total = 0;
+        sent = 0;
+    }
+
+    // Calls `f` with each piece of text not sent yet, in order, without copying any of it
+    template <typename F> void for_each_piece(F &&f) const {
+        size_t skip = sent;
+        for (const auto &segment : segments) {
+            if (skip >= segment.size) {
+                skip -= segment.size;
+                continue;
+            }
+            f(std::string_view(data(segment) + skip, segment.size - skip));
+            skip = 0;
+        }
+    }
+
+    // Copies whatever is still held by reference into the buffer, for when the text it points
+    // to, such as a world version no game uses any more, is about to be freed
+    void copy_static() {
+        std::pmr::string pending(copied.get_allocator());
+        pending.reserve(size());
+        for_each_piece([&pending](std::string_view piece) { pending += piece; });
+        clear();
+        copy(pending.data(), pending.size());
+    }
+
+    void write_to(std::ostream &out) {
+        for (const auto &segment : segments) {
+            out.write(data(segment), static_cast<std::streamsize>(segment.size));
+        }
+        clear();
+    }
+
+    // Sends what the file descriptor takes, usually everything in one writev. False on an error
+    // other than EAGAIN; what was not sent stays buffered for the next call.
+    bool write_to(int fd) {
+        while (!empty()) {
+            iovec iov[IOV_MAX];
+            int count = 0;
+            size_t skip = sent;
+            for (const auto &segment : segments) {
+                if (count == IOV_MAX) break;
+                if (skip >= segment.size) {
+                    skip -= segment.size;
+                    continue;
+                }
+                iov[count].iov_base = const_cast<char *>(data(segment) + skip);
+                iov[count].iov_len = segment.size - skip;
+                skip = 0;
+                count++;
+            }
+            ssize_t n = ::writev(fd, iov, count);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        clear();
+        return true;
+    }
+
+private:
+    // A piece of static text, or a range of `copied` if text is null
+    struct Segment {
+        const char *text;
+        size_t offset;
+        size_t size;
+    };
+
+    std::pmr::vector<Segment> segments;
+    std::pmr::string copied;
+    size_t total = 0;
+    size_t sent = 0;
+
+    const char *data(const Segment &segment) const {
+        return segment.text ? segment.text : copied.data() + segment.offset;
+    }
+
+    void add_static(const char *text, size_t size) {
+        if (size < COPY_BELOW) {
+            copy(text, size);
+        } else {
+            segments.push_back(Segment{text, 0, size});
+            total += size;
+        }
+    }
+
+    void copy(const char *text, size_t size) {
+        if (size == 0) return;
+        if (!segments.empty() && !segments.back().text &&
+            segments.back().offset + segments.back().size == copied.size()) {
+            segments.back().size += size;
+        } else {
+            segments.push_back(Segment{nullptr, copied.size(), size});
+        }
+        copied.append(text, size);
+        total += size;
+    }
+};
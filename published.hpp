@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// A value read by many threads and now and then replaced as a whole, read-copy-update style: a
+// new version is built off to the side and published with one atomic pointer swap. Readers pin
+// the version that is current and use it for as long as they like, without ever taking a lock;
+// pinning is a few atomic operations, and using a pinned version costs nothing at all. A version
+// that has been replaced is freed once the last pin on it is gone.
+//
+// Freeing is safe because a reader announces itself before it loads the pointer and only leaves
+// once it holds a reference: after a swap, publish waits until no reader is inside that window,
+// so none can still be about to take a reference to the old version when the publisher's own is
+// dropped. Publishing is meant to be rare; it may wait a moment, readers never do.
+
+template <typename T> class Published {
+    struct Version {
+        T value;
+        uint64_t number;
+        std::atomic<size_t> references{1}; // the pins, and one for being current
+        std::atomic<size_t> &live;
+
+        Version(T value, uint64_t number, std::atomic<size_t> &live)
+            : value(std::move(value)), number(number), live(live) {
+            live.fetch_add(1);
+        }
+    };
+
+public:
+    // Keeps one version alive. Empty when default-constructed or moved from.
+    class Pin {
+    public:
+        Pin() = default;
+
+        Pin(Pin &&other) noexcept : version(std::exchange(other.version, nullptr)) {}
+
+        Pin &operator=(Pin &&other) noexcept {
+            if (this != &other) {
+                release(version);
+                version = std::exchange(other.version, nullptr);
+            }
+            return *this;
+        }
+
+        ~Pin() { release(version); }
+
+        const T &operator*() const { return version->value; }
+        const T *operator->() const { return &version->value; }
+        explicit operator bool() const { return version != nullptr; }
+
+    private:
+        friend class Published;
+        Version *version = nullptr;
+
+        explicit Pin(Version *version) : version(version) {}
+    };
+
+    explicit Published(T initial) : current(new Version(std::move(initial), 1, live)) {}
+
+    Published(const Published &) = delete;
+    Published &operator=(const Published &) = delete;
+
+    // Every pin must be gone by now
+    ~Published() { release(current.load()); }
+
+    Pin pin() const {
+        readers.fetch_add(1);
+        Version *version = current.load();
+        version->references.fetch_add(1);
+        readers.fetch_sub(1);
+        return Pin(version);
+    }
+
+    // Makes `value` the current version and returns its number. Readers that already pinned the
+    // one before keep it until they let go.
+    uint64_t publish(T value) {
+        std::lock_guard<std::mutex> lock(publishing); // between publishers only
+        Version *next = new Version(std::move(value), current.load()->number + 1, live);
+        Version *previous = current.exchange(next);
+        while (readers.load() != 0) std::this_thread::yield();
+        release(previous);
+        return next->number;
+    }
+
+    // Versions still in memory, the current one included
+    size_t versions() const { return live.load(); }
+
+private:
+    std::atomic<size_t> live{0}; // before current, which counts itself in
+    std::atomic<Version *> current;
+    mutable std::atomic<size_t> readers{0}; // between loading current and pinning it
+    std::mutex publishing;
+
+    static void release(Version *version) {
+        if (version && version->references.fetch_sub(1) == 1) {
+            version->live.fetch_sub(1);
+            delete version;
+        }
+    }
+};
@@ -0,0 +1,295 @@
+#pragma once
+
+#include "world.hpp"
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A saved game is only what it changed: the template it was played in is identified by a
+// fingerprint of its structure and every table is compared against it, so a record is a few
+// dozen bytes however large the world is. Layout, after a 2-byte magic, a version byte and the
+// fingerprint:
+//   the language being played in, as a length and its name, empty for the world's own text
+//   room, then the inventory as a count and item ids, in the order they were picked up
+//   door locked, chest locked, chest opened, NPC alive and NPC gave-item flags, 8 to a byte
+//   NPCs whose health changed, as a count and (index delta, zigzag health) pairs
+//   NPCs given the item they ask for, as a count and (index delta, times given) pairs
+//   rooms searched or with a different item, as a count and (index delta, (item + 1) * 2 +
+//   searched) pairs
+// Numbers are LEB128 varints and index deltas count from one past the previous index.
+
+constexpr char SAVE_MAGIC[2] = {'T', 'S'};
+constexpr uint8_t SAVE_VERSION = 3;
+
+// Hashes what a save record's indices refer to: the rooms and how they connect, doors, chests
+// and their keys, NPCs and the items they all hold or ask for. Text is left out, as are NPCs'
+// name ids, so a world whose text was edited still takes the saves made before.
+inline uint32_t world_fingerprint(const WorldTemplate &world) {
+    uint32_t hash = 2166136261u;
+    auto add = [&hash](uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            hash = (hash ^ ((value >> shift) & 0xff)) * 16777619u;
+        }
+    };
+    add(world.start_room());
+    add(static_cast<uint32_t>(world.items().size()));
+    const RuleItems &rules = world.rule_items();
+    for (ItemId item : {rules.rusted_knife, rules.obsidian_dagger, rules.blood_bottle,
+                        rules.orbis_dei}) {
+        add(item);
+    }
+    add(static_cast<uint32_t>(world.rooms().size()));
+    for (const RoomRecord &room : world.rooms()) {
+        add(room.chest);
+        add(room.floor_item);
+    }
+    for (const ExitRecord &exit : world.exits()) {
+        add(exit.target);
+        add(exit.door);
+    }
+    add(static_cast<uint32_t>(world.doors().size()));
+    for (const DoorRecord &door : world.doors()) add(door.required_key);
+    add(static_cast<uint32_t>(world.chests().size()));
+    for (const ChestRecord &chest : world.chests()) {
+        add(chest.contained_item);
+        add(static_cast<uint32_t>(chest.key_count));
+        for (ItemId key : world.keys(chest)) add(key);
+    }
+    add(static_cast<uint32_t>(world.npcs().size()));
+    for (const NpcRecord &npc : world.npcs()) {
+        for (uint32_t field : {npc.required_item, npc.death_item,
+                               static_cast<uint32_t>(npc.health), npc.hostile, npc.drop_item,
+                               npc.give_player_item, npc.room}) {
+            add(field);
+        }
+    }
+    return hash;
+}
+
+class SaveWriter {
+public:
+    explicit SaveWriter(std::string &out) : out(out) {}
+
+    void number(uint64_t value) {
+        do {
+            out += static_cast<char>((value & 0x7f) | (value > 0x7f ? 0x80 : 0));
+            value >>= 7;
+        } while (value != 0);
+    }
+
+    template <typename Get> void flags(size_t count, Get &&get) {
+        for (size_t i = 0; i < count; i += 8) {
+            uint8_t byte = 0;
+            for (size_t b = 0; b < 8 && i + b < count; b++) {
+                byte |= static_cast<uint8_t>((get(static_cast<uint32_t>(i + b)) ? 1 : 0) << b);
+            }
+            out += static_cast<char>(byte);
+        }
+    }
+
+private:
+    std::string &out;
+};
+
+class SaveReader {
+public:
+    explicit SaveReader(std::string_view in) : in(in) {}
+
+    uint64_t number() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = next();
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        throw std::runtime_error("corrupt save record");
+    }
+
+    // A number that must be below `limit`
+    uint32_t index(uint64_t limit) {
+        uint64_t value = number();
+        if (value >= limit) throw std::runtime_error("corrupt save record");
+        return static_cast<uint32_t>(value);
+    }
+
+    template <typename Set> void flags(size_t count, Set &&set) {
+        for (size_t i = 0; i < count; i += 8) {
+            uint8_t byte = next();
+            for (size_t b = 0; b < 8 && i + b < count; b++) {
+                set(static_cast<uint32_t>(i + b), (byte >> b) & 1);
+            }
+        }
+    }
+
+    uint8_t next() {
+        if (pos == in.size()) throw std::runtime_error("truncated save record");
+        return static_cast<uint8_t>(in[pos++]);
+    }
+
+    bool done() const { return pos == in.size(); }
+
+private:
+    std::string_view in;
+    size_t pos = 0;
+};
+
+inline std::string write_save(const WorldTemplate &world, std::string_view language, RoomId room,
+                              std::span<const ItemId> inventory, const WorldState &state) {
+    std::string record(SAVE_MAGIC, sizeof(SAVE_MAGIC));
+    record += static_cast<char>(SAVE_VERSION);
+    uint32_t fingerprint = world_fingerprint(world);
+    for (int shift = 0; shift < 32; shift += 8) record += static_cast<char>(fingerprint >> shift);
+
+    SaveWriter out(record);
+    out.number(language.size());
+    record += language;
+    out.number(room);
+    out.number(inventory.size());
+    for (ItemId item : inventory) out.number(item);
+
+    auto rooms = world.rooms();
+    auto npcs = world.npcs();
+    const size_t doors = world.doors().size(), chests = world.chests().size();
+    out.flags(doors, [&](uint32_t i) { return state.door_locked(i); });
+    out.flags(chests, [&](uint32_t i) { return state.chest_locked(i); });
+    out.flags(chests, [&](uint32_t i) { return state.chest_opened(i); });
+    out.flags(npcs.size(), [&](uint32_t i) { return state.npc_alive(i); });
+    out.flags(npcs.size(), [&](uint32_t i) { return state.npc_gave_item(i); });
+
+    // Sparse sections: a count, then entries for what differs from the template
+    auto sparse = [&](size_t size, auto &&changed, auto &&write_entry) {
+        size_t count = 0;
+        for (uint32_t i = 0; i < size; i++) count += changed(i);
+        out.number(count);
+        size_t next = 0;
+        for (uint32_t i = 0; i < size; i++) {
+            if (!changed(i)) continue;
+            out.number(i - next);
+            write_entry(i);
+            next = i + 1;
+        }
+    };
+    sparse(
+        npcs.size(), [&](uint32_t i) { return state.npc_health(i) != npcs[i].health; },
+        [&](uint32_t i) {
+            int64_t health = state.npc_health(i);
+            out.number(static_cast<uint64_t>((health << 1) ^ (health >> 63)));
+        });
+    sparse(
+        npcs.size(), [&](uint32_t i) { return state.npc_received(i) != 0; },
+        [&](uint32_t i) { out.number(state.npc_received(i)); });
+    sparse(
+        rooms.size(),
+        [&](uint32_t i) {
+            return state.room_searched(i) || state.room_item(i) != rooms[i].floor_item;
+        },
+        [&](uint32_t i) {
+            uint64_t item = state.room_item(i) == NO_ITEM ? 0 : uint64_t{state.room_item(i)} + 1;
+            out.number(item * 2 + state.room_searched(i));
+        });
+    return record;
+}
+
+// Throws if the record is corrupt or was saved in a different world; nothing is changed then.
+// The language is only named: whether it can still be played in is for the caller to decide.
+inline void read_save(const WorldTemplate &world, std::string_view record, std::string &language,
+                      RoomId &room, std::pmr::vector<ItemId> &inventory, WorldState &state) {
+    SaveReader in(record);
+    if (record.size() < sizeof(SAVE_MAGIC) + 5 ||
+        record.substr(0, sizeof(SAVE_MAGIC)) != std::string_view(SAVE_MAGIC, sizeof(SAVE_MAGIC))) {
+        throw std::runtime_error("not a save record");
+    }
+    for (size_t i = 0; i < sizeof(SAVE_MAGIC); i++) in.next();
+    if (in.next() != SAVE_VERSION) throw std::runtime_error("unsupported save version");
+    uint32_t fingerprint = 0;
+    for (int shift = 0; shift < 32; shift += 8) fingerprint |= uint32_t{in.next()} << shift;
+    if (fingerprint != world_fingerprint(world)) {
+        throw std::runtime_error("the save is from a different world");
+    }
+
+    std::string saved_language(in.index(record.size()), '\0');
+    for (char &c : saved_language) c = static_cast<char>(in.next());
+    const size_t items = world.items().size();
+    RoomId saved_room = in.index(world.rooms().size());
+    // Item lists can repeat items, but each takes at least a byte of the record
+    std::vector<ItemId> saved_inventory(in.index(record.size()));
+    for (ItemId &item : saved_inventory) item = in.index(items);
+
+    WorldState saved(world);
+    const size_t doors = world.doors().size(), chests = world.chests().size();
+    const size_t npcs = world.npcs().size(), rooms = world.rooms().size();
+    in.flags(doors, [&](uint32_t i, bool value) { saved.set_door_locked(i, value); });
+    in.flags(chests, [&](uint32_t i, bool value) { saved.set_chest_locked(i, value); });
+    in.flags(chests, [&](uint32_t i, bool value) { saved.set_chest_opened(i, value); });
+    in.flags(npcs, [&](uint32_t i, bool value) { saved.set_npc_alive(i, value); });
+    in.flags(npcs, [&](uint32_t i, bool value) { saved.set_npc_gave_item(i, value); });
+
+    auto sparse = [&](size_t size, auto &&read_entry) {
+        size_t count = in.index(size + 1);
+        size_t next = 0;
+        for (size_t n = 0; n < count; n++) {
+            uint32_t i = static_cast<uint32_t>(next + in.index(size - next));
+            read_entry(i);
+            next = i + 1;
+        }
+    };
+    sparse(npcs, [&](uint32_t i) {
+        uint64_t zigzag = in.number();
+        saved.set_npc_health(i, static_cast<int32_t>(static_cast<int64_t>(zigzag >> 1) ^
+                                                     -static_cast<int64_t>(zigzag & 1)));
+    });
+    sparse(npcs, [&](uint32_t i) { saved.set_npc_received(i, in.index(UINT32_MAX)); });
+    sparse(rooms, [&](uint32_t i) {
+        uint64_t value = in.index((items + 1) * 2);
+        uint64_t item = value / 2;
+        saved.set_room_item(i, item == 0 ? NO_ITEM : static_cast<ItemId>(item - 1));
+        saved.set_room_searched(i, value & 1);
+    });
+    if (!in.done()) throw std::runtime_error("corrupt save record");
+
+    language = std::move(saved_language);
+    room = saved_room;
+    inventory.assign(saved_inventory.begin(), saved_inventory.end());
+    state = std::move(saved);
+}
+
+// Save records as words a player can type back in: base32, lowercase so that the game's own
+// lowercasing of input leaves them intact
+constexpr std::string_view SAVE_CODE_ALPHABET = "abcdefghijklmnopqrstuvwxyz234567";
+
+inline std::string to_save_code(std::string_view record) {
+    std::string code;
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (char c : record) {
+        buffer = (buffer << 8) | static_cast<uint8_t>(c);
+        bits += 8;
+        while (bits >= 5) {
+            bits -= 5;
+            code += SAVE_CODE_ALPHABET[(buffer >> bits) & 31];
+        }
+    }
+    if (bits > 0) code += SAVE_CODE_ALPHABET[(buffer << (5 - bits)) & 31];
+    return code;
+}
+
+inline std::string from_save_code(std::string_view code) {
+    std::string record;
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (char c : code) {
+        size_t value = SAVE_CODE_ALPHABET.find(c);
+        if (value == std::string_view::npos) throw std::runtime_error("not a save code");
+        buffer = (buffer << 5) | static_cast<uint32_t>(value);
+        bits += 5;
+        if (bits >= 8) {
+            bits -= 8;
+            record += static_cast<char>((buffer >> bits) & 0xff);
+        }
+    }
+    return record;
+}
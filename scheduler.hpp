@@ -0,0 +1,218 @@
+#pragma once
+
+#include "output.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs many sessions, each a Game fed lines through on_line(std::string &, Output &), on a pool
+// of worker threads. A session with lines waiting is in exactly one worker's deque of ready
+// sessions, and is run by one worker at a time, so its lines always run in the order posted.
+//
+// Every session has a home worker. With Placement::Static it only ever runs there, as the
+// server's connections do; with Placement::Stealing a worker whose deque is empty takes a ready
+// session from another's, so a few busy sessions cannot hold back the rest of their shard while
+// other cores sit idle. Each deque is a first-in, first-out line: sessions join it at the back
+// and owners run them from the front, while thieves take from the back so they rarely contend
+// with the owner. A session runs a bounded batch of lines before going to the back again, so
+// however many lines keep arriving, no ready session waits longer than one turn of its line.
+//
+// What a line writes is handed to the output handler, if there is one, on the worker that ran it.
+
+enum class Placement { Static, Stealing };
+
+template <typename Game> class SessionScheduler {
+public:
+    static constexpr size_t BATCH = 16;
+
+    struct WorkerStats {
+        uint64_t lines = 0;
+        uint64_t steals = 0;
+    };
+
+    using OutputHandler = std::function<void(size_t session, Output &out)>;
+
+    SessionScheduler(unsigned threads, Placement placement, OutputHandler handler = {})
+        : placement(placement), handler(std::move(handler)), workers(std::max(threads, 1u)) {
+        for (unsigned i = 0; i < workers.size(); i++) {
+            workers[i].thread = std::thread([this, i] { run(i); });
+        }
+    }
+
+    SessionScheduler(const SessionScheduler &) = delete;
+    SessionScheduler &operator=(const SessionScheduler &) = delete;
+
+    ~SessionScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &worker : workers) worker.thread.join();
+    }
+
+    // Sessions are numbered in the order added; their home workers take turns
+    size_t add(Game game) {
+        auto session = std::make_unique<Session>(std::move(game));
+        session->id = sessions.size();
+        session->home = static_cast<unsigned>(sessions.size() % workers.size());
+        sessions.push_back(std::move(session));
+        return sessions.size() - 1;
+    }
+
+    // Queues a line for a session; sessions may only be added before the first line is posted
+    void post(size_t id, std::string line) {
+        Session &session = *sessions[id];
+        pending.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(session.mutex);
+            session.inbox.push_back(std::move(line));
+            if (session.queued) return; // already on its way through a deque
+            session.queued = true;
+        }
+        make_ready(session.home, session);
+    }
+
+    // Blocks until every line posted so far has run, or been dropped as its game had ended
+    void drain() {
+        std::unique_lock<std::mutex> lock(idle_mutex);
+        drained.wait(lock, [this] { return pending.load() == 0; });
+    }
+
+    std::vector<WorkerStats> stats() const {
+        std::vector<WorkerStats> result;
+        for (const auto &worker : workers) {
+            result.push_back(WorkerStats{worker.lines.load(), worker.steals.load()});
+        }
+        return result;
+    }
+
+private:
+    struct Session {
+        Game game;
+        size_t id = 0;
+        unsigned home = 0;
+        std::mutex mutex; // guards inbox and queued
+        std::deque<std::string> inbox;
+        bool queued = false; // in a deque or being run
+        bool finished = false;
+
+        explicit Session(Game game) : game(std::move(game)) {}
+    };
+
+    struct Worker {
+        std::thread thread;
+        std::mutex mutex;
+        std::deque<Session *> ready;
+        std::atomic<uint64_t> lines{0};
+        std::atomic<uint64_t> steals{0};
+    };
+
+    Placement placement;
+    OutputHandler handler;
+    std::vector<Worker> workers;
+    std::vector<std::unique_ptr<Session>> sessions;
+    std::atomic<size_t> pending{0};
+    std::atomic<size_t> ready_count{0};
+    std::mutex idle_mutex;
+    std::condition_variable wake;
+    std::condition_variable drained;
+    bool stopping = false;
+
+    void make_ready(unsigned worker, Session &session) {
+        {
+            std::lock_guard<std::mutex> lock(workers[worker].mutex);
+            workers[worker].ready.push_back(&session);
+        }
+        ready_count.fetch_add(1);
+        {
+            // Taken so a worker about to sleep cannot miss this
+            std::lock_guard<std::mutex> lock(idle_mutex);
+        }
+        if (placement == Placement::Stealing) {
+            wake.notify_one();
+        } else {
+            wake.notify_all(); // only the home worker will do, and it is not known which waits
+        }
+    }
+
+    Session *take(unsigned index) {
+        Worker &own = workers[index];
+        {
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.ready.empty()) {
+                Session *session = own.ready.front();
+                own.ready.pop_front();
+                return session;
+            }
+        }
+        if (placement != Placement::Stealing) return nullptr;
+        for (size_t n = 1; n < workers.size(); n++) {
+            Worker &victim = workers[(index + n) % workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.ready.empty()) {
+                Session *session = victim.ready.back();
+                victim.ready.pop_back();
+                own.steals.fetch_add(1, std::memory_order_relaxed);
+                return session;
+            }
+        }
+        return nullptr;
+    }
+
+    bool has_work(unsigned index) {
+        if (placement == Placement::Stealing) return ready_count.load() != 0;
+        std::lock_guard<std::mutex> lock(workers[index].mutex);
+        return !workers[index].ready.empty();
+    }
+
+    void run(unsigned index) {
+        Worker &worker = workers[index];
+        Output out;
+        std::string line;
+        while (true) {
+            Session *session = take(index);
+            if (!session) {
+                std::unique_lock<std::mutex> lock(idle_mutex);
+                wake.wait(lock, [&] { return stopping || has_work(index); });
+                if (stopping) return;
+                continue;
+            }
+            ready_count.fetch_sub(1);
+
+            size_t done = 0;
+            bool more = true;
+            for (size_t n = 0; n < BATCH && more; n++) {
+                {
+                    std::lock_guard<std::mutex> lock(session->mutex);
+                    line = std::move(session->inbox.front());
+                    session->inbox.pop_front();
+                }
+                if (!session->finished) {
+                    session->finished = !session->game.on_line(line, out);
+                    if (handler) handler(session->id, out);
+                    out.clear();
+                    worker.lines.fetch_add(1, std::memory_order_relaxed);
+                }
+                done++;
+                std::lock_guard<std::mutex> lock(session->mutex);
+                more = !session->inbox.empty();
+                if (!more) session->queued = false;
+            }
+            // Lines left over wait their turn behind the other ready sessions
+            if (more) make_ready(index, *session);
+            if (pending.fetch_sub(done) == done) {
+                std::lock_guard<std::mutex> lock(idle_mutex);
+                drained.notify_all();
+            }
+        }
+    }
+};
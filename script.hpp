@@ -0,0 +1,41 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// Recorded command scripts, as played by headless mode and the benchmarks, and a stream buffer
+// to send the games' output nowhere.
+
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+};
+
+struct Script {
+    std::string path;
+    std::string commands;
+};
+
+// Reads one command per line, skipping blank lines and '#' comments
+inline bool load_script(const std::filesystem::path &path, std::vector<Script> &scripts) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Could not open script " << path.string() << "\n";
+        return false;
+    }
+    Script script{path.string(), ""};
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') continue;
+        script.commands += line.substr(start);
+        script.commands += '\n';
+    }
+    scripts.push_back(script);
+    return true;
+}
@@ -0,0 +1,713 @@
+#pragma once
+
+#include "journal.hpp"
+#include "output.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <charconv>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <optional>
+#include <pthread.h>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/random.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Line-based network server. Every connection gets its own Game, created when it connects and
+// fed one line of input at a time. Connections are sharded across a fixed pool of worker
+// threads, each running its own edge-triggered epoll loop, and a connection stays on the worker
+// that accepted it, so game state is never shared between threads.
+//
+// The factory creates a connection's Game and writes its greeting; after that the Game provides
+//   bool on_line(std::string &line, Output &out)    false once the game is over
+//   std::string save() const                       its state, for hibernation
+//   void load(std::string_view record)             the state saved before, into a fresh Game
+//   void describe(Output &out)                     where the player is, after a load
+//
+// Each batch of lines read from a connection is answered with one writev of its Output.
+//
+// With a hibernate directory set, a game whose connection has been idle for a while is saved to
+// a file there and destroyed, keeping only the socket; the next line from the client restores
+// it into a new Game from the factory.
+//
+// With a journal directory set, every line is appended to its worker's journal (journal.hpp)
+// before it runs, and the answers of a batch of connections are held back until one fdatasync has
+// made all their lines durable. Each connection is told its session id, 64 bits from the kernel's
+// random source that no other session has. On startup the journals
+// are replayed through fresh Games to rebuild the sessions that were cut off, and a player gets
+// theirs back by sending "resume <id>" as the first line of a new connection. A worker compacts
+// its journal into one snapshot per session whenever it has doubled in size since the last time,
+// so replay takes time in proportion to the sessions, not to their history. Sessions nobody
+// resumes within hibernate_after of startup are dropped.
+//
+// Given a reload function, the server runs it on SIGHUP, on the thread that waits for signals;
+// it is up to the function and the factory to make what it reloads visible to new Games.
+
+struct ServerOptions {
+    std::string tcp_host = "127.0.0.1";
+    int tcp_port = -1; // no TCP listener if negative
+    std::string unix_path;
+    unsigned threads = 0; // one per core if 0
+    size_t max_line = 4096;
+    size_t max_pending_input = 1024 * 1024;
+    size_t max_pending_output = 64 * 1024; // stop reading commands until the client catches up
+    std::string hibernate_dir;             // no hibernation if empty
+    std::chrono::seconds hibernate_after{300};
+    std::string journal_dir; // no journal if empty
+    size_t journal_compact_bytes = 64 * 1024 * 1024;
+};
+
+// Session ids as players type them
+inline std::string session_name(uint64_t session) {
+    char digits[16];
+    for (int i = 15; i >= 0; i--, session >>= 4) digits[i] = "0123456789abcdef"[session & 15];
+    return std::string(digits, sizeof(digits));
+}
+
+[[noreturn]] inline void throw_errno(const std::string &what) {
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+inline int listen_tcp(const std::string &host, int port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (::inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        throw std::runtime_error("invalid IPv4 address " + host);
+    }
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) throw_errno("socket");
+    int on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        ::listen(fd, SOMAXCONN) != 0) {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        throw_errno(host + ":" + std::to_string(port));
+    }
+    return fd;
+}
+
+inline int listen_unix(const std::string &path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("socket path too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) throw_errno("socket");
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        ::listen(fd, SOMAXCONN) != 0) {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        throw_errno(path);
+    }
+    return fd;
+}
+
+template <typename Game> class Server {
+public:
+    using Factory = std::function<Game(Output &)>;
+
+    Server(ServerOptions options, Factory factory, std::function<void()> reload = {})
+        : options(std::move(options)), factory(std::move(factory)), reload(std::move(reload)) {}
+
+    // Serves until SIGINT or SIGTERM
+    void run() {
+        raise_file_limit();
+
+        // Workers inherit this mask, so only the sigwait below sees the signals
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        if (reload) sigaddset(&signals, SIGHUP);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+        std::signal(SIGPIPE, SIG_IGN);
+
+        if (options.tcp_port >= 0) {
+            listeners.push_back(listen_tcp(options.tcp_host, options.tcp_port));
+            std::cerr << "Listening on " << options.tcp_host << ":" << options.tcp_port << "\n";
+        }
+        if (!options.unix_path.empty()) {
+            listeners.push_back(listen_unix(options.unix_path));
+            std::cerr << "Listening on " << options.unix_path << "\n";
+        }
+        if (listeners.empty()) throw std::runtime_error("nothing to listen on");
+
+        stop_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (stop_fd < 0) throw_errno("eventfd");
+
+        unsigned count = options.threads ? options.threads : std::thread::hardware_concurrency();
+        workers = std::vector<Worker>(std::max(count, 1u));
+        for (unsigned i = 0; i < workers.size(); i++) workers[i].index = i;
+        if (!options.journal_dir.empty()) recover();
+        for (auto &worker : workers) {
+            worker.epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+            if (worker.epoll_fd < 0) throw_errno("epoll_create1");
+            // Every worker waits on the listeners; EPOLLEXCLUSIVE wakes only one per connection
+            for (int fd : listeners) {
+                if (!watch(worker, fd, EPOLLIN | EPOLLEXCLUSIVE)) throw_errno("epoll_ctl");
+            }
+            if (!watch(worker, stop_fd, EPOLLIN)) throw_errno("epoll_ctl");
+        }
+        std::cerr << "Serving with " << workers.size() << " worker thread(s)\n";
+        for (auto &worker : workers) {
+            worker.thread = std::thread([this, &worker] { run_worker(worker); });
+        }
+
+        int signal = 0;
+        while (sigwait(&signals, &signal) == 0 && signal == SIGHUP) reload();
+        uint64_t one = 1;
+        if (::write(stop_fd, &one, sizeof(one)) < 0) throw_errno("eventfd write");
+
+        uint64_t served = 0;
+        for (auto &worker : workers) {
+            worker.thread.join();
+            served += worker.accepted;
+            ::close(worker.epoll_fd);
+        }
+        for (int fd : listeners) ::close(fd);
+        ::close(stop_fd);
+        if (!options.unix_path.empty()) ::unlink(options.unix_path.c_str());
+        std::cerr << "Stopped after serving " << served << " connection(s)\n";
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Connection {
+        int fd;
+        std::string input;
+        Output output;
+        bool finished = false;    // the game is over
+        bool peer_closed = false; // the client will send nothing more
+        Clock::time_point last_active = Clock::now();
+        std::optional<Game> game; // empty while hibernating
+        std::string parked_path;  // where the game is saved while hibernating
+        uint64_t session = 0;     // 0 without a journal
+        uint64_t sequence = 0;    // lines journaled so far
+        bool resumed = false;     // rebuilt from the journal of an earlier run
+
+        Connection(int fd, uint64_t session, const Factory &factory) : fd(fd), session(session) {
+            if (session) {
+                std::string name = session_name(session);
+                std::string banner = "Session " + name +
+                                     "; if the server restarts, reconnect and send \"resume " +
+                                     name + "\" to carry on.\n";
+                output << std::string_view(banner);
+            }
+            game.emplace(factory(output));
+        }
+    };
+
+    // A resumed session that ended, and how many compactions its snapshot's worker had begun
+    // by then; any it begins after that leave the snapshot out
+    struct ResumedEnd {
+        uint64_t session;
+        uint64_t compactions_begun;
+    };
+
+    struct Worker {
+        int epoll_fd = -1;
+        std::thread thread;
+        std::vector<std::unique_ptr<Connection>> connections; // indexed by fd
+        std::string line;
+        uint64_t accepted = 0;
+        Clock::time_point last_sweep = Clock::now();
+        unsigned index = 0;
+        std::unique_ptr<Journal> journal;
+        std::vector<int> awaiting_commit; // connections whose answers wait for the journal
+        size_t compact_at = 0;
+        std::vector<ResumedEnd> resumed_ended; // kept through compaction, see compact()
+        std::atomic<uint64_t> compactions_begun{0}; // counted as they read `recovered`
+        std::atomic<uint64_t> compactions_written{0}; // the last one begun that was written
+    };
+
+    // A session rebuilt from the journal, waiting for its player to resume it
+    struct Recovered {
+        std::string record;
+        uint64_t sequence;
+        bool claimed = false;
+        Clock::time_point since = Clock::now(); // forgotten after hibernate_after unclaimed
+    };
+
+    ServerOptions options;
+    Factory factory;
+    std::function<void()> reload;
+    std::vector<int> listeners;
+    int stop_fd = -1;
+    std::vector<Worker> workers;
+    std::mutex recovered_mutex; // also guards open_sessions
+    std::unordered_map<uint64_t, Recovered> recovered;
+    std::unordered_set<uint64_t> open_sessions; // the ids of every connection's session
+
+    static void raise_file_limit() {
+        rlimit limit{};
+        if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+            limit.rlim_cur = limit.rlim_max;
+            ::setrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
+
+    static bool watch(Worker &worker, int fd, uint32_t events) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        return ::epoll_ctl(worker.epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+
+    void run_worker(Worker &worker) {
+        epoll_event events[256];
+        bool hibernating = !options.hibernate_dir.empty();
+        bool sweeping = hibernating || !options.journal_dir.empty();
+        while (true) {
+            int ready = ::epoll_wait(worker.epoll_fd, events, 256, sweeping ? 1000 : -1);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            if (sweeping && Clock::now() - worker.last_sweep >= std::chrono::seconds(1)) {
+                worker.last_sweep = Clock::now();
+                if (hibernating) hibernate_idle(worker);
+                if (worker.journal) expire_recovered(worker);
+            }
+            for (int i = 0; i < ready; i++) {
+                int fd = events[i].data.fd;
+                if (fd == stop_fd) {
+                    // Sessions stay in the journal, to be resumed after a restart
+                    for (auto &connection : worker.connections) {
+                        if (connection) close_connection(worker, *connection, false);
+                    }
+                    worker.connections.clear();
+                    if (worker.journal) commit(worker);
+                    return;
+                }
+                if (std::find(listeners.begin(), listeners.end(), fd) != listeners.end()) {
+                    accept_connections(worker, fd);
+                    continue;
+                }
+                if (!worker.connections[static_cast<size_t>(fd)]) continue;
+                Connection &connection = *worker.connections[static_cast<size_t>(fd)];
+                bool open = true;
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                    open = read_input(connection);
+                }
+                if (open && !connection.game && !connection.input.empty()) open = wake(connection);
+                if (open) open = process_input(worker, connection);
+                if (!open) close_connection(worker, connection);
+            }
+            if (worker.journal) commit_journal(worker);
+        }
+    }
+
+    // Takes a bounded batch so a burst of connections is spread over the workers
+    void accept_connections(Worker &worker, int listener) {
+        for (int batch = 0; batch < 64; batch++) {
+            int fd = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return; // EAGAIN, or the connection went away already
+            int on = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)); // fails on Unix sockets
+
+            if (worker.connections.size() <= static_cast<size_t>(fd)) {
+                worker.connections.resize(static_cast<size_t>(fd) + 1);
+            }
+            auto &connection = worker.connections[static_cast<size_t>(fd)];
+            uint64_t session = 0;
+            if (worker.journal && (session = new_session()) == 0) {
+                ::close(fd);
+                continue;
+            }
+            connection = std::make_unique<Connection>(fd, session, factory);
+            worker.accepted++;
+            if (!watch(worker, fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET) ||
+                !flush(*connection)) {
+                close_connection(worker, *connection);
+            }
+        }
+    }
+
+    // An id for a new session, taken by it until its connection closes; 0 if the kernel has no
+    // randomness to give. Ids are secret, as they are all it takes to resume someone's game, so
+    // they come from getrandom rather than a generator whose state other ids would give away.
+    uint64_t new_session() {
+        while (true) {
+            uint64_t id = 0;
+            ssize_t got = ::getrandom(&id, sizeof(id), 0);
+            if (got < 0 && errno == EINTR) continue;
+            if (got != static_cast<ssize_t>(sizeof(id))) {
+                std::cerr << "Could not draw a session id: " << std::strerror(errno) << "\n";
+                return 0;
+            }
+            std::lock_guard<std::mutex> lock(recovered_mutex);
+            if (id != 0 && !recovered.contains(id) && open_sessions.insert(id).second) return id;
+        }
+    }
+
+    void release_session(uint64_t id) {
+        if (id == 0) return;
+        std::lock_guard<std::mutex> lock(recovered_mutex);
+        open_sessions.erase(id);
+    }
+
+    // Edge-triggered: drains the socket; false if the connection failed or is flooding us
+    bool read_input(Connection &connection) {
+        char chunk[4096];
+        while (true) {
+            ssize_t n = ::read(connection.fd, chunk, sizeof(chunk));
+            if (n > 0) {
+                connection.last_active = Clock::now();
+                connection.input.append(chunk, static_cast<size_t>(n));
+                if (connection.input.size() > options.max_pending_input) return false;
+            } else if (n == 0) {
+                connection.peer_closed = true; // answer what was sent, then hang up
+                return true;
+            } else if (errno == EINTR) {
+                continue;
+            } else {
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+        }
+    }
+
+    // Runs every complete line while the client keeps up with the output; false once the
+    // connection should be closed. Input held back for a slow reader is picked up again on the
+    // next EPOLLOUT.
+    bool process_input(Worker &worker, Connection &connection) {
+        while (true) {
+            size_t start = 0;
+            while (!connection.finished && connection.output.size() < options.max_pending_output) {
+                size_t end = connection.input.find('\n', start);
+                if (end == std::string::npos) break;
+                worker.line.assign(connection.input, start, end - start);
+                start = end + 1;
+                if (!worker.line.empty() && worker.line.back() == '\r') worker.line.pop_back();
+                if (!worker.journal) {
+                    connection.finished = !connection.game->on_line(worker.line, connection.output);
+                } else if (connection.sequence == 0 && worker.line.starts_with("resume ")) {
+                    resume(worker, connection, worker.line.substr(7));
+                } else {
+                    Journal &journal = *worker.journal;
+                    journal.append(JournalRecord::Line, connection.session, ++connection.sequence,
+                                   worker.line);
+                    connection.finished = !connection.game->on_line(worker.line, connection.output);
+                    if (connection.finished) end_session(worker, connection);
+                }
+            }
+            connection.input.erase(0, start);
+            // Answers go out once the lines they answer are on disk
+            if (worker.journal && worker.journal->pending()) {
+                worker.awaiting_commit.push_back(connection.fd);
+                return true;
+            }
+            if (!flush(connection)) return false;
+            if (!connection.output.empty()) return true;
+
+            bool more = !connection.finished && connection.input.find('\n') != std::string::npos;
+            if (!more) break;
+        }
+        if (connection.finished || connection.peer_closed) return false;
+        return connection.input.size() <= options.max_line;
+    }
+
+    // Parks the games of connections that have been quiet for hibernate_after with nothing left to
+    // send. A game that cannot be written out stays in memory.
+    void hibernate_idle(Worker &worker) {
+        Clock::time_point now = Clock::now();
+        for (auto &entry : worker.connections) {
+            if (!entry || !entry->game || !entry->output.empty() || !entry->input.empty() ||
+                now - entry->last_active < options.hibernate_after) {
+                continue;
+            }
+            Connection &connection = *entry;
+            std::string path = options.hibernate_dir + "/" + std::to_string(::getpid()) + "-" +
+                               std::to_string(connection.fd) + ".save";
+            std::string record = connection.game->save();
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(record.data(), static_cast<std::streamsize>(record.size()));
+            file.close();
+            if (!file) {
+                ::unlink(path.c_str());
+                continue;
+            }
+            connection.game.reset();
+            connection.parked_path = std::move(path);
+        }
+    }
+
+    // Restores a hibernating game before its next line; false if it could not be restored
+    bool wake(Connection &connection) {
+        std::ifstream file(connection.parked_path, std::ios::binary);
+        std::stringstream record;
+        record << file.rdbuf();
+        try {
+            Output greeting; // already sent when the game started
+            connection.game.emplace(factory(greeting));
+            connection.game->load(record.str());
+        } catch (const std::exception &e) {
+            std::cerr << "Could not restore " << connection.parked_path << ": " << e.what()
+                      << "\n";
+            connection.game.reset();
+            return false;
+        }
+        ::unlink(connection.parked_path.c_str());
+        connection.parked_path.clear();
+        return true;
+    }
+
+    // Sends as much output as the socket takes; false if the connection failed
+    static bool flush(Connection &connection) { return connection.output.write_to(connection.fd); }
+
+    // A session whose player hangs up is over; one cut off by the server stopping is not
+    void close_connection(Worker &worker, Connection &connection, bool ending = true) {
+        int fd = connection.fd;
+        if (worker.journal && ending && !connection.finished) end_session(worker, connection);
+        if (!connection.parked_path.empty()) ::unlink(connection.parked_path.c_str());
+        release_session(connection.session);
+        ::close(fd); // also removes it from the epoll set
+        worker.connections[static_cast<size_t>(fd)].reset();
+    }
+
+    void end_session(Worker &worker, Connection &connection) {
+        if (connection.session == 0) return;
+        worker.journal->append(JournalRecord::End, connection.session, connection.sequence);
+        if (connection.resumed) {
+            const Worker &owner = workers[connection.session % workers.size()];
+            worker.resumed_ended.push_back(
+                ResumedEnd{connection.session, owner.compactions_begun.load()});
+        }
+    }
+
+    // Replays every journal into the sessions left unfinished, keeps them as save records until
+    // their players resume them, and starts each worker's journal with just their snapshots
+    void recover() {
+        namespace fs = std::filesystem;
+        fs::create_directories(options.journal_dir);
+        std::vector<fs::path> old_files;
+        std::vector<JournalEntry> entries;
+        for (const auto &file : fs::directory_iterator(options.journal_dir)) {
+            std::string name = file.path().filename().string();
+            if (!name.starts_with("shard-") || !name.ends_with(".journal")) continue;
+            old_files.push_back(file.path());
+            std::vector<JournalEntry> read = read_journal(file.path().string());
+            entries.insert(entries.end(), std::make_move_iterator(read.begin()),
+                           std::make_move_iterator(read.end()));
+        }
+
+        std::vector<std::vector<JournalEntry>> shards(workers.size());
+        for (auto &[id, history] : collect_journal_sessions(std::move(entries))) {
+            std::string record;
+            try {
+                Output discarded;
+                Game game = factory(discarded);
+                if (history.snapshot) game.load(*history.snapshot);
+                bool running = true;
+                for (std::string &line : history.lines) {
+                    discarded.clear();
+                    running = game.on_line(line, discarded);
+                    if (!running) break;
+                }
+                if (!running) continue; // finished before its End record was written
+                record = game.save();
+            } catch (const std::exception &e) {
+                std::cerr << "Could not rebuild session " << session_name(id) << ": " << e.what()
+                          << "\n";
+                continue;
+            }
+            shards[id % workers.size()].push_back(
+                JournalEntry{JournalRecord::Snapshot, id, history.sequence, record});
+            recovered.emplace(id, Recovered{std::move(record), history.sequence});
+        }
+
+        for (Worker &worker : workers) {
+            std::string path = journal_path(worker.index);
+            worker.journal = std::make_unique<Journal>(path);
+            worker.journal->rewrite(shards[worker.index]);
+            worker.compact_at = std::max(options.journal_compact_bytes, 2 * worker.journal->size());
+            std::erase(old_files, fs::path(path));
+        }
+        for (const fs::path &file : old_files) fs::remove(file); // from a run with more workers
+        std::cerr << "Recovered " << recovered.size() << " session(s) from the journal\n";
+    }
+
+    std::string journal_path(unsigned index) const {
+        return options.journal_dir + "/shard-" + std::to_string(index) + ".journal";
+    }
+
+    // Forgets the sessions on this worker's shard that nobody resumed within hibernate_after; its
+    // journal holds their snapshots, which the End records close
+    void expire_recovered(Worker &worker) {
+        Clock::time_point now = Clock::now();
+        std::lock_guard<std::mutex> lock(recovered_mutex);
+        for (auto it = recovered.begin(); it != recovered.end();) {
+            if (it->first % workers.size() == worker.index && !it->second.claimed &&
+                now - it->second.since >= options.hibernate_after) {
+                worker.journal->append(JournalRecord::End, it->first, it->second.sequence);
+                it = recovered.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Swaps the connection's new session for one rebuilt from the journal
+    void resume(Worker &worker, Connection &connection, const std::string &name) {
+        uint64_t id = 0;
+        auto [end, error] = std::from_chars(name.data(), name.data() + name.size(), id, 16);
+        Recovered found{};
+        {
+            std::lock_guard<std::mutex> lock(recovered_mutex);
+            auto it = recovered.find(id);
+            if (error == std::errc() && end == name.data() + name.size() && it != recovered.end() &&
+                !it->second.claimed) {
+                it->second.claimed = true;
+                found = it->second;
+            }
+        }
+        if (!found.claimed) {
+            connection.output << "There is no session " << std::string_view(name)
+                              << " to resume.\n";
+            return;
+        }
+        // A record that no longer fits the world (reloaded since) stays for a later attempt,
+        // and the player keeps the game they have
+        std::optional<Game> game;
+        try {
+            Output greeting; // the connection's own greeting stands in for it
+            game.emplace(factory(greeting));
+            game->load(found.record);
+        } catch (const std::exception &e) {
+            std::cerr << "Could not resume session " << name << ": " << e.what() << "\n";
+            {
+                std::lock_guard<std::mutex> lock(recovered_mutex);
+                recovered[id].claimed = false;
+            }
+            connection.output << "Session " << std::string_view(name)
+                              << " could not be resumed: " << std::string_view(e.what()) << "\n";
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(recovered_mutex);
+            open_sessions.erase(connection.session);
+            open_sessions.insert(id);
+        }
+        // Greeting text still waiting for a slow reader or a commit may point into the world
+        // version the old game pins, which dropping it can free
+        connection.output.copy_static();
+        connection.game = std::move(game);
+        connection.session = id;
+        connection.sequence = found.sequence;
+        connection.resumed = true;
+        connection.output << "Resumed session " << std::string_view(name) << ".\n\n";
+        connection.game->describe(connection.output);
+
+        // Only once this snapshot is durable may compaction elsewhere drop the old one
+        worker.journal->append(JournalRecord::Snapshot, id, found.sequence, found.record);
+        if (commit(worker)) {
+            std::lock_guard<std::mutex> lock(recovered_mutex);
+            recovered.erase(id);
+        }
+    }
+
+    // False, after asking the server to stop, if the journal could not be written: answering
+    // without it would promise players a durability they no longer have
+    bool commit(Worker &worker) {
+        try {
+            worker.journal->commit();
+            return true;
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << "\n";
+            ::kill(::getpid(), SIGTERM);
+            return false;
+        }
+    }
+
+    // One fdatasync covers the lines of every connection that ran some this round. Sending their
+    // answers can let lines held back for slow readers run, which are committed in turn.
+    void commit_journal(Worker &worker) {
+        while (worker.journal->pending() || !worker.awaiting_commit.empty()) {
+            if (!commit(worker)) {
+                worker.awaiting_commit.clear();
+                return;
+            }
+            std::vector<int> ready;
+            ready.swap(worker.awaiting_commit);
+            for (int fd : ready) {
+                auto &entry = worker.connections[static_cast<size_t>(fd)];
+                if (entry && !process_input(worker, *entry)) close_connection(worker, *entry);
+            }
+        }
+        if (worker.journal->size() >= worker.compact_at) compact(worker);
+    }
+
+    // Rewrites the worker's journal as one snapshot per session on its shard: its connections'
+    // and, by id, sessions still waiting to be resumed. Resumed sessions that ended here keep
+    // their End records, as the snapshot they were resumed from may be in another journal, until
+    // that journal has been compacted without it.
+    void compact(Worker &worker) {
+        std::erase_if(worker.resumed_ended, [this](const ResumedEnd &end) {
+            const Worker &owner = workers[end.session % workers.size()];
+            return owner.compactions_written.load() > end.compactions_begun;
+        });
+        std::vector<JournalEntry> entries;
+        for (const auto &entry : worker.connections) {
+            if (!entry || entry->session == 0 || entry->sequence == 0 || entry->finished) continue;
+            entries.push_back(JournalEntry{JournalRecord::Snapshot, entry->session,
+                                           entry->sequence, saved_game(*entry)});
+        }
+        uint64_t number = 0;
+        {
+            std::lock_guard<std::mutex> lock(recovered_mutex);
+            number = worker.compactions_begun.fetch_add(1) + 1;
+            for (const auto &[id, session] : recovered) {
+                if (id % workers.size() != worker.index) continue;
+                entries.push_back(
+                    JournalEntry{JournalRecord::Snapshot, id, session.sequence, session.record});
+            }
+        }
+        for (const ResumedEnd &end : worker.resumed_ended) {
+            entries.push_back(JournalEntry{JournalRecord::End, end.session, 0, {}});
+        }
+        try {
+            worker.journal->rewrite(entries);
+            worker.compactions_written.store(number);
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << "\n"; // the journal grows on, and compaction is tried again
+        }
+        worker.compact_at = std::max(options.journal_compact_bytes, 2 * worker.journal->size());
+    }
+
+    static std::string saved_game(const Connection &connection) {
+        if (connection.game) return connection.game->save();
+        std::ifstream file(connection.parked_path, std::ios::binary);
+        std::stringstream record;
+        record << file.rdbuf();
+        return record.str();
+    }
+};
@@ -0,0 +1,128 @@
+#include "tenebrae.h"
+#include "dungeon.hpp"
+#include "game_session.hpp"
+#include "world_builder.hpp"
+#include <exception>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The C ABI of libtenebrae over GameSession. Every entry point catches what the engine throws
+// and turns it into a return value, as exceptions must not unwind into C.
+
+struct tnb_world {
+    WorldTemplate world;
+};
+
+struct tnb_session {
+    std::unique_ptr<GameSession> game;
+    std::vector<tnb_text> texts; // the game's output spans, as C sees them
+};
+
+namespace {
+
+thread_local std::string last_error;
+
+template <typename Fallback, typename Body> Fallback guarded(Fallback fallback, Body &&body) {
+    try {
+        return body();
+    } catch (const std::exception &e) {
+        last_error = e.what();
+    } catch (...) {
+        last_error = "unknown error";
+    }
+    return fallback;
+}
+
+tnb_status to_status(GameStatus status) {
+    switch (status) {
+    case GameStatus::Playing:
+        return TNB_PLAYING;
+    case GameStatus::Won:
+        return TNB_WON;
+    case GameStatus::Died:
+        return TNB_DIED;
+    default:
+        return TNB_QUIT;
+    }
+}
+
+void expose(tnb_session &session, std::span<const std::string_view> pieces) {
+    session.texts.clear();
+    for (std::string_view piece : pieces) {
+        session.texts.push_back(tnb_text{piece.data(), piece.size()});
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+int tnb_abi_version(void) { return TNB_ABI_VERSION; }
+
+const char *tnb_last_error(void) { return last_error.c_str(); }
+
+tnb_world *tnb_world_builtin(void) {
+    return guarded<tnb_world *>(nullptr, [] { return new tnb_world{builtin_world()}; });
+}
+
+tnb_world *tnb_world_load(const char *path) {
+    return guarded<tnb_world *>(nullptr, [&] {
+        if (!path) throw std::invalid_argument("no world path");
+        return new tnb_world{load_world(path)};
+    });
+}
+
+void tnb_world_destroy(tnb_world *world) { delete world; }
+
+tnb_session *tnb_session_create(const tnb_world *world) {
+    return guarded<tnb_session *>(nullptr, [&] {
+        if (!world) throw std::invalid_argument("no world");
+        auto session = std::make_unique<tnb_session>();
+        session->game = GameSession::create(world->world);
+        expose(*session, session->game->output());
+        return session.release();
+    });
+}
+
+void tnb_session_destroy(tnb_session *session) { delete session; }
+
+void tnb_session_output(const tnb_session *session, const tnb_text **texts, size_t *count) {
+    *texts = session->texts.data();
+    *count = session->texts.size();
+}
+
+tnb_status tnb_session_step(tnb_session *session, const char *command, size_t size,
+                            const tnb_text **texts, size_t *count) {
+    *texts = nullptr;
+    *count = 0;
+    return guarded(TNB_ERROR, [&] {
+        expose(*session, session->game->step(std::string_view(command, size)));
+        tnb_session_output(session, texts, count);
+        return to_status(session->game->status());
+    });
+}
+
+tnb_status tnb_session_status(const tnb_session *session) {
+    return guarded(TNB_ERROR, [&] { return to_status(session->game->status()); });
+}
+
+size_t tnb_session_state(const tnb_session *session, char *buffer, size_t size) {
+    return guarded(size_t{0}, [&] {
+        std::string record = session->game->state();
+        if (record.size() <= size) record.copy(buffer, record.size());
+        return record.size();
+    });
+}
+
+tnb_status tnb_session_restore(tnb_session *session, const char *record, size_t size) {
+    return guarded(TNB_ERROR, [&] {
+        session->game->restore(std::string_view(record, size));
+        return to_status(session->game->status());
+    });
+}
+
+} // extern "C"
@@ -0,0 +1,93 @@
+#ifndef TENEBRAE_H
+#define TENEBRAE_H
+
+/*
+ * libtenebrae: the game engine as a library, for hosts that play sessions in-process rather
+ * than through the terminal or the server. A host loads a world once, creates a session per
+ * player on it, and steps each session with the player's commands; what the game says comes
+ * back as an array of text spans, with no stdio in between.
+ *
+ * Worlds may be shared by any number of sessions on any threads. A session is used by one
+ * thread at a time, and keeps its world alive, so a world may be destroyed before its
+ * sessions. Output spans stay valid until the session's next step or its destruction.
+ *
+ * Functions that can fail return NULL or TNB_ERROR and leave a message for
+ * tnb_last_error(). Nothing is ever printed, and no C++ exception crosses this interface.
+ *
+ * The ABI only ever grows: functions keep their signatures, and new ones bump
+ * TNB_ABI_VERSION.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define TNB_API __attribute__((visibility("default")))
+#else
+#define TNB_API
+#endif
+
+#define TNB_ABI_VERSION 1
+
+typedef struct tnb_world tnb_world;
+typedef struct tnb_session tnb_session;
+
+/* A piece of output; not NUL-terminated */
+typedef struct tnb_text {
+    const char *data;
+    size_t size;
+} tnb_text;
+
+typedef enum tnb_status {
+    TNB_ERROR = -1,
+    TNB_PLAYING = 0,
+    TNB_WON = 1,
+    TNB_DIED = 2,
+    TNB_QUIT = 3
+} tnb_status;
+
+/* TNB_ABI_VERSION as the library was built */
+TNB_API int tnb_abi_version(void);
+
+/* Why the last call on this thread failed */
+TNB_API const char *tnb_last_error(void);
+
+TNB_API tnb_world *tnb_world_builtin(void);
+
+/* A world definition file or compiled image, as with --world */
+TNB_API tnb_world *tnb_world_load(const char *path);
+
+TNB_API void tnb_world_destroy(tnb_world *world);
+
+/* A new game, whose greeting is waiting in tnb_session_output */
+TNB_API tnb_session *tnb_session_create(const tnb_world *world);
+
+TNB_API void tnb_session_destroy(tnb_session *session);
+
+/* What the game said last: its greeting, until the first step */
+TNB_API void tnb_session_output(const tnb_session *session, const tnb_text **texts,
+                                size_t *count);
+
+/* Plays one command and points `texts` at what the game answered. Blank commands are
+ * skipped, and once the game is over nothing more is played. */
+TNB_API tnb_status tnb_session_step(tnb_session *session, const char *command, size_t size,
+                                    const tnb_text **texts, size_t *count);
+
+TNB_API tnb_status tnb_session_status(const tnb_session *session);
+
+/* Writes the game's save record (everything it changed so far, a few dozen bytes) into
+ * `buffer` if it fits, and returns its size either way, like snprintf without the NUL. */
+TNB_API size_t tnb_session_state(const tnb_session *session, char *buffer, size_t size);
+
+/* Puts the game back as a save record from the same world left it; on failure the game is
+ * left as it was */
+TNB_API tnb_status tnb_session_restore(tnb_session *session, const char *record, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
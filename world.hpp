@@ -0,0 +1,494 @@
+#pragma once
+
+#include "fuzzy.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <memory_resource>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+// A world is one flat image: a header, fixed-size record tables and a text pool, with every
+// reference stored as an index into a table or an offset into the pool. The same bytes are used
+// whether they were compiled in memory from the built-in dungeon or mmap'd from a file; loading
+// one checks every reference in it once, so games can follow them without checking. The image
+// is shared read-only by every game; what a game can change lives in its own WorldState.
+
+using RoomId = uint32_t;
+using ItemId = uint32_t;
+using NameId = uint32_t; // NPCs that share a name share a NameId
+constexpr RoomId NO_ROOM = UINT32_MAX;
+constexpr ItemId NO_ITEM = UINT32_MAX;
+constexpr NameId NO_NAME = UINT32_MAX;
+constexpr uint32_t NO_DOOR = UINT32_MAX;
+constexpr uint32_t NO_CHEST = UINT32_MAX;
+constexpr uint32_t NO_NPC = UINT32_MAX;
+
+enum class Direction : uint8_t { North, East, South, West };
+
+constexpr size_t DIRECTION_COUNT = 4;
+
+constexpr std::string_view DIRECTION_NAMES[DIRECTION_COUNT] = {"north", "east", "south", "west"};
+
+constexpr std::optional<Direction> find_direction(std::string_view name) {
+    for (size_t i = 0; i < DIRECTION_COUNT; i++) {
+        if (DIRECTION_NAMES[i] == name) return static_cast<Direction>(i);
+    }
+    return std::nullopt;
+}
+
+inline std::string to_lowercase(std::string_view input) {
+    std::string result(input);
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return result;
+}
+
+// Image format, native byte order
+struct TextRef {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+// A view into a world's text pool, which outlives every game played in it, so output can refer
+// to it instead of copying it
+struct Text : std::string_view {
+    constexpr explicit Text(std::string_view text) : std::string_view(text) {}
+};
+
+struct RoomRecord {
+    TextRef name;
+    TextRef description;
+    TextRef search_description;
+    uint32_t chest;
+    ItemId floor_item; // found by searching the room
+};
+
+// Every room has one exit slot per direction, stored together as DIRECTION_COUNT consecutive
+// records at room * DIRECTION_COUNT, so moving is a single indexed load
+struct ExitRecord {
+    RoomId target; // NO_ROOM if there is no exit that way
+    uint32_t door; // NO_DOOR if the way is always open
+};
+
+struct DoorRecord {
+    ItemId required_key; // NO_ITEM if the door starts unlocked
+};
+
+struct ChestRecord {
+    ItemId contained_item;
+    uint32_t first_key; // index into the chest key table
+    uint32_t key_count;
+};
+
+struct ItemRecord {
+    TextRef name;
+    TextRef description;
+};
+
+struct NpcRecord {
+    TextRef name;
+    TextRef description;
+    TextRef dialogue;
+    TextRef post_receive_item_dialogue;
+    NameId name_id;
+    ItemId required_item;
+    ItemId death_item;
+    int32_t health;
+    uint32_t hostile;
+    ItemId drop_item;
+    ItemId give_player_item;
+    RoomId room;
+};
+
+// Symbol table entry: a lowercased name and the id it was interned to, sorted by name
+struct SymbolRecord {
+    TextRef name;
+    uint32_t id;
+};
+
+struct Section {
+    uint32_t offset;
+    uint32_t count;
+};
+
+struct WorldHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t size;
+    RoomId start_room;
+    uint32_t text_checksum; // FNV-1a of the text pool
+    Section rooms;
+    Section exits;
+    Section doors;
+    Section chests;
+    Section chest_keys;
+    Section items;
+    Section npcs;
+    Section item_symbols;
+    Section npc_symbols;
+    Section text;
+};
+
+// Items the game rules refer to by name (weapons, the blood bottle, the winning orb), resolved
+// once when a world is loaded; NO_ITEM if the world does not have them
+struct RuleItems {
+    ItemId rusted_knife = NO_ITEM;
+    ItemId obsidian_dagger = NO_ITEM;
+    ItemId blood_bottle = NO_ITEM;
+    ItemId orbis_dei = NO_ITEM;
+};
+
+constexpr char WORLD_MAGIC[8] = {'T', 'N', 'B', 'W', 'O', 'R', 'L', 'D'};
+constexpr uint32_t WORLD_VERSION = 4;
+
+// Maps a whole file read-only, unmapped when the last copy of the pointer goes; `what` names
+// the kind of file in errors
+inline std::shared_ptr<const char> map_read_only(const std::string &path, size_t min_size,
+                                                 const std::string &what, size_t &size) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Could not open " + what + " " + path);
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(min_size)) {
+        ::close(fd);
+        throw std::runtime_error(path + " is not a " + what);
+    }
+    size = static_cast<size_t>(st.st_size);
+    void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) throw std::runtime_error("Could not map " + what + " " + path);
+    return std::shared_ptr<const char>(static_cast<const char *>(mapped), [size](const char *p) {
+        ::munmap(const_cast<char *>(p), size);
+    });
+}
+
+// Writes a file that others may have mapped with map_read_only: the bytes go to a new file, which
+// is synced and renamed over the old one, so a mapping of the old file keeps seeing it as it was
+// for as long as it lasts. False, with the old file left alone, if it could not be written.
+inline bool replace_file(const std::string &path, std::span<const char> bytes) {
+    std::string temporary = path + ".tmp" + std::to_string(::getpid());
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    size_t written = 0;
+    while (written < bytes.size()) {
+        ssize_t n = ::write(fd, bytes.data() + written, bytes.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        written += static_cast<size_t>(n);
+    }
+    bool ok = written == bytes.size() && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || ::rename(temporary.c_str(), path.c_str()) != 0) {
+        ::unlink(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+class WorldTemplate {
+public:
+    // Takes ownership of an image compiled in memory
+    explicit WorldTemplate(std::vector<char> image) {
+        auto bytes = std::make_shared<std::vector<char>>(std::move(image));
+        base = bytes->data();
+        storage = std::shared_ptr<const char>(bytes, bytes->data());
+        check(bytes->size());
+    }
+
+    // Maps a compiled image file read-only; pages are faulted in as they are touched
+    static WorldTemplate map_file(const std::string &path) {
+        size_t size = 0;
+        WorldTemplate world;
+        world.storage = map_read_only(path, sizeof(WorldHeader), "world image", size);
+        world.base = world.storage.get();
+        world.check(size);
+        return world;
+    }
+
+    static bool is_image(const char *data, size_t size) {
+        return size >= sizeof(WORLD_MAGIC) &&
+               std::memcmp(data, WORLD_MAGIC, sizeof(WORLD_MAGIC)) == 0;
+    }
+
+    std::string_view bytes() const { return {base, header->size}; }
+
+    RoomId start_room() const { return header->start_room; }
+
+    const RuleItems &rule_items() const { return rules; }
+
+    Text text(TextRef ref) const {
+        return Text({base + header->text.offset + ref.offset, ref.length});
+    }
+
+    // Identifies the text pool that TextRefs index; locale packs are made for one pool
+    uint32_t text_checksum() const { return header->text_checksum; }
+
+    std::span<const RoomRecord> rooms() const { return table<RoomRecord>(header->rooms); }
+    std::span<const ExitRecord> exits() const { return table<ExitRecord>(header->exits); }
+    std::span<const DoorRecord> doors() const { return table<DoorRecord>(header->doors); }
+    std::span<const ChestRecord> chests() const { return table<ChestRecord>(header->chests); }
+    std::span<const ItemId> chest_keys() const { return table<ItemId>(header->chest_keys); }
+    std::span<const ItemRecord> items() const { return table<ItemRecord>(header->items); }
+    std::span<const NpcRecord> npcs() const { return table<NpcRecord>(header->npcs); }
+
+    std::span<const ExitRecord, DIRECTION_COUNT> exits(RoomId room) const {
+        return exits().subspan(room * DIRECTION_COUNT).first<DIRECTION_COUNT>();
+    }
+
+    const ExitRecord &exit(RoomId room, Direction direction) const {
+        return exits()[room * DIRECTION_COUNT + static_cast<size_t>(direction)];
+    }
+
+    std::span<const ItemId> keys(const ChestRecord &chest) const {
+        return chest_keys().subspan(chest.first_key, chest.key_count);
+    }
+
+    Text item_name(ItemId item) const { return text(items()[item].name); }
+
+    // Names are looked up once, already lowercased; everything after that compares ids
+    ItemId find_item(std::string_view name) const {
+        return find_symbol(table<SymbolRecord>(header->item_symbols), name, NO_ITEM);
+    }
+
+    // The item a mistyped name was meant to be, if exactly one is close enough
+    ItemId find_item_near(std::string_view name) const {
+        if (ItemId item = find_item(name); item != NO_ITEM) return item;
+        ClosestMatch match(name);
+        for (const SymbolRecord &symbol : table<SymbolRecord>(header->item_symbols)) {
+            match.consider(text(symbol.name), symbol.id);
+        }
+        return match.id(NO_ITEM);
+    }
+
+    NameId find_npc_name(std::string_view name) const {
+        return find_symbol(table<SymbolRecord>(header->npc_symbols), name, NO_NAME);
+    }
+
+    Text lowercase_npc_name(NameId name) const {
+        return text(table<SymbolRecord>(header->npc_symbols)[name].name);
+    }
+
+private:
+    std::shared_ptr<const char> storage;
+    const char *base = nullptr;
+    const WorldHeader *header = nullptr;
+    RuleItems rules;
+
+    WorldTemplate() = default;
+
+    template <typename T> std::span<const T> table(Section section) const {
+        return {reinterpret_cast<const T *>(base + section.offset), section.count};
+    }
+
+    uint32_t find_symbol(std::span<const SymbolRecord> symbols, std::string_view name,
+                         uint32_t missing) const {
+        auto i = std::lower_bound(
+            symbols.begin(), symbols.end(), name,
+            [this](const SymbolRecord &symbol, std::string_view n) { return text(symbol.name) < n; });
+        return i != symbols.end() && text(i->name) == name ? i->id : missing;
+    }
+
+    bool records_valid() const {
+        const uint32_t pool = header->text.count, room_count = header->rooms.count,
+                       item_count = header->items.count, key_count = header->chest_keys.count;
+        auto text_ok = [pool](TextRef ref) {
+            return ref.offset <= pool && ref.length <= pool - ref.offset;
+        };
+        auto item_ok = [item_count](ItemId item) { return item == NO_ITEM || item < item_count; };
+
+        for (const RoomRecord &room : rooms()) {
+            if (!text_ok(room.name) || !text_ok(room.description) ||
+                !text_ok(room.search_description) || !item_ok(room.floor_item) ||
+                (room.chest != NO_CHEST && room.chest >= header->chests.count)) {
+                return false;
+            }
+        }
+        for (const ExitRecord &exit : exits()) {
+            if ((exit.target != NO_ROOM && exit.target >= room_count) ||
+                (exit.door != NO_DOOR && exit.door >= header->doors.count)) {
+                return false;
+            }
+        }
+        for (const DoorRecord &door : doors()) {
+            if (!item_ok(door.required_key)) return false;
+        }
+        for (const ChestRecord &chest : chests()) {
+            // Opening a chest always hands over what is in it; the builder never makes one empty
+            if (chest.contained_item >= item_count || chest.first_key > key_count ||
+                chest.key_count > key_count - chest.first_key) {
+                return false;
+            }
+        }
+        for (ItemId key : chest_keys()) {
+            if (key >= item_count) return false;
+        }
+        for (const ItemRecord &item : items()) {
+            if (!text_ok(item.name) || !text_ok(item.description)) return false;
+        }
+        for (const NpcRecord &npc : npcs()) {
+            if (!text_ok(npc.name) || !text_ok(npc.description) || !text_ok(npc.dialogue) ||
+                !text_ok(npc.post_receive_item_dialogue) ||
+                npc.name_id >= header->npc_symbols.count || !item_ok(npc.required_item) ||
+                !item_ok(npc.death_item) || !item_ok(npc.drop_item) ||
+                !item_ok(npc.give_player_item) || npc.room >= room_count) {
+                return false;
+            }
+        }
+        for (const SymbolRecord &symbol : table<SymbolRecord>(header->item_symbols)) {
+            if (!text_ok(symbol.name) || symbol.id >= item_count) return false;
+        }
+        for (const SymbolRecord &symbol : table<SymbolRecord>(header->npc_symbols)) {
+            if (!text_ok(symbol.name) || symbol.id >= header->npc_symbols.count) return false;
+        }
+        return true;
+    }
+
+    template <typename T> bool fits(Section section, size_t size) const {
+        return section.offset % alignof(T) == 0 && section.offset <= size &&
+               section.count <= (size - section.offset) / sizeof(T);
+    }
+
+    // An image may be corrupt or half-written, so besides the header and table bounds every
+    // index and text ref in its records is checked, and nothing read from it later can point
+    // outside it
+    void check(size_t size) {
+        header = reinterpret_cast<const WorldHeader *>(base);
+        if (size < sizeof(WorldHeader) || !is_image(base, size)) {
+            throw std::runtime_error("not a world image");
+        }
+        if (header->version != WORLD_VERSION) {
+            throw std::runtime_error("unsupported world image version " +
+                                     std::to_string(header->version));
+        }
+        if (header->size != size || !fits<RoomRecord>(header->rooms, size) ||
+            header->exits.count != header->rooms.count * DIRECTION_COUNT ||
+            !fits<ExitRecord>(header->exits, size) || !fits<DoorRecord>(header->doors, size) ||
+            !fits<ChestRecord>(header->chests, size) ||
+            !fits<ItemId>(header->chest_keys, size) || !fits<ItemRecord>(header->items, size) ||
+            !fits<NpcRecord>(header->npcs, size) ||
+            !fits<SymbolRecord>(header->item_symbols, size) ||
+            !fits<SymbolRecord>(header->npc_symbols, size) || !fits<char>(header->text, size) ||
+            header->start_room >= header->rooms.count || !records_valid()) {
+            throw std::runtime_error("truncated or corrupt world image");
+        }
+        rules = RuleItems{find_item("rusted knife"), find_item("obsidian dagger"),
+                          find_item("blood bottle"), find_item("orbis dei")};
+    }
+};
+
+// Everything a game can change, indexed the same way as the world it was created from. Flags
+// are bitsets and values are dense arrays, all laid out in one block of 32-bit words, so copying
+// a state to snapshot or reset a game is a single memcpy and comparing two states is a memcmp.
+// The block comes from the given memory resource, a session's arena when it has one; copies
+// take theirs from the default resource.
+class WorldState {
+public:
+    explicit WorldState(const WorldTemplate &world,
+                        std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+        : words(memory) {
+        auto rooms = world.rooms();
+        auto doors = world.doors();
+        auto chests = world.chests();
+        auto npcs = world.npcs();
+        uint32_t size = 0;
+        auto bits = [&size](size_t count) { return std::exchange(size, size + words_for(count)); };
+        auto values = [&size](size_t count) {
+            return std::exchange(size, size + static_cast<uint32_t>(count));
+        };
+        layout = Layout{bits(rooms.size()),  values(rooms.size()), bits(doors.size()),
+                        bits(chests.size()), bits(chests.size()),  bits(npcs.size()),
+                        bits(npcs.size()),   values(npcs.size()),  values(npcs.size())};
+        words.assign(size, 0);
+
+        for (RoomId room = 0; room < rooms.size(); room++) {
+            words[layout.room_item + room] = rooms[room].floor_item;
+        }
+        for (uint32_t door = 0; door < doors.size(); door++) {
+            set_door_locked(door, doors[door].required_key != NO_ITEM);
+        }
+        for (uint32_t chest = 0; chest < chests.size(); chest++) {
+            set_chest_locked(chest, chests[chest].key_count != 0);
+        }
+        for (uint32_t npc = 0; npc < npcs.size(); npc++) {
+            set_npc_alive(npc, true);
+            set_npc_health(npc, npcs[npc].health);
+        }
+    }
+
+    bool room_searched(RoomId room) const { return bit(layout.room_searched, room); }
+    void set_room_searched(RoomId room, bool value) { set_bit(layout.room_searched, room, value); }
+
+    // The item searching the room finds, NO_ITEM once taken
+    ItemId room_item(RoomId room) const { return words[layout.room_item + room]; }
+    void set_room_item(RoomId room, ItemId item) { words[layout.room_item + room] = item; }
+
+    bool door_locked(uint32_t door) const { return bit(layout.door_locked, door); }
+    void set_door_locked(uint32_t door, bool value) { set_bit(layout.door_locked, door, value); }
+
+    bool chest_locked(uint32_t chest) const { return bit(layout.chest_locked, chest); }
+    void set_chest_locked(uint32_t chest, bool value) {
+        set_bit(layout.chest_locked, chest, value);
+    }
+
+    bool chest_opened(uint32_t chest) const { return bit(layout.chest_opened, chest); }
+    void set_chest_opened(uint32_t chest, bool value) {
+        set_bit(layout.chest_opened, chest, value);
+    }
+
+    bool npc_alive(uint32_t npc) const { return bit(layout.npc_alive, npc); }
+    void set_npc_alive(uint32_t npc, bool value) { set_bit(layout.npc_alive, npc, value); }
+
+    bool npc_gave_item(uint32_t npc) const { return bit(layout.npc_gave_item, npc); }
+    void set_npc_gave_item(uint32_t npc, bool value) {
+        set_bit(layout.npc_gave_item, npc, value);
+    }
+
+    // Times the NPC was given the item it asks for
+    uint32_t npc_received(uint32_t npc) const { return words[layout.npc_received + npc]; }
+    void set_npc_received(uint32_t npc, uint32_t count) {
+        words[layout.npc_received + npc] = count;
+    }
+
+    int32_t npc_health(uint32_t npc) const {
+        return static_cast<int32_t>(words[layout.npc_health + npc]);
+    }
+    void set_npc_health(uint32_t npc, int32_t health) {
+        words[layout.npc_health + npc] = static_cast<uint32_t>(health);
+    }
+
+    // The whole state, for hashing or comparing
+    std::span<const uint32_t> raw() const { return words; }
+
+    bool operator==(const WorldState &other) const { return words == other.words; }
+
+private:
+    // Where each table starts, in words
+    struct Layout {
+        uint32_t room_searched, room_item, door_locked, chest_locked, chest_opened, npc_alive,
+            npc_gave_item, npc_received, npc_health;
+    };
+
+    Layout layout;
+    std::pmr::vector<uint32_t> words;
+
+    static uint32_t words_for(size_t bits) { return static_cast<uint32_t>((bits + 31) / 32); }
+
+    bool bit(uint32_t table, size_t i) const { return (words[table + i / 32] >> (i % 32)) & 1; }
+
+    void set_bit(uint32_t table, size_t i, bool value) {
+        uint32_t mask = uint32_t{1} << (i % 32);
+        uint32_t &word = words[table + i / 32];
+        word = value ? word | mask : word & ~mask;
+    }
+};
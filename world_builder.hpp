@@ -0,0 +1,633 @@
+#pragma once
+
+#include "world.hpp"
+#include <array>
+#include <fstream>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <unordered_map>
+
+// Definitions collected by WorldBuilder, from build_world() or from a world definition file,
+// before they are compiled into an image
+
+class Item {
+public:
+    std::string item_name;
+    std::string item_description;
+
+    Item() = default;
+
+    Item(std::string_view name, std::string_view description)
+        : item_name(name), item_description(description) {}
+};
+
+class Door {
+public:
+    std::string required_key;
+
+    Door(const std::string &key = "") : required_key(to_lowercase(key)) {}
+};
+
+class Chest {
+public:
+    ItemId contained_item;
+    std::vector<std::string> required_keys;
+
+    Chest(ItemId item, const std::vector<std::string> &keys = {}) : contained_item(item) {
+        for (const auto &key : keys) {
+            required_keys.push_back(to_lowercase(key));
+        }
+    }
+};
+
+class NPC {
+public:
+    std::string name;
+    std::string description;
+    int health;
+    bool hostile;
+    std::string required_item;
+    std::string dialogue;
+    std::string death_item;
+    std::string post_receive_item_dialogue;
+    ItemId drop_item = NO_ITEM;
+    ItemId give_player_item = NO_ITEM;
+    RoomId room = NO_ROOM;
+
+    NPC(std::string_view npc_name, std::string_view npc_description, int npc_health = 5,
+        bool is_hostile = false, std::string_view npc_required_item = "",
+        std::string_view npc_dialogue = "", std::string_view npc_death_item = "",
+        std::string_view npc_post_receive_item_dialogue = "", ItemId npc_drop_item = NO_ITEM,
+        ItemId npc_give_player_item = NO_ITEM)
+        : name(npc_name), description(npc_description), health(npc_health), hostile(is_hostile),
+          required_item(npc_required_item), dialogue(npc_dialogue), death_item(npc_death_item),
+          post_receive_item_dialogue(npc_post_receive_item_dialogue), drop_item(npc_drop_item),
+          give_player_item(npc_give_player_item) {}
+};
+
+class Room {
+public:
+    std::string name;
+    std::string room_description;
+    std::string search_description;
+    std::array<RoomId, DIRECTION_COUNT> room_exits{NO_ROOM, NO_ROOM, NO_ROOM, NO_ROOM};
+    std::array<std::optional<Door>, DIRECTION_COUNT> doors;
+    uint32_t chest = NO_CHEST;
+    ItemId floor_item = NO_ITEM;
+};
+
+inline Direction parse_direction(const std::string &name) {
+    std::optional<Direction> direction = find_direction(name);
+    if (!direction) throw std::runtime_error("unknown direction " + name);
+    return *direction;
+}
+
+class WorldBuilder {
+public:
+    std::vector<Item> items;
+    std::vector<Room> rooms;
+    std::vector<Chest> chests;
+    std::vector<NPC> npcs;
+    RoomId start_room = NO_ROOM;
+
+    ItemId define_item(const std::string &name, std::string_view description) {
+        if (item_ids.count(name)) throw std::runtime_error("item \"" + name + "\" defined twice");
+        item_ids[name] = static_cast<ItemId>(items.size());
+        items.emplace_back(name, description);
+        return static_cast<ItemId>(items.size() - 1);
+    }
+
+    ItemId item(const std::string &name) const {
+        auto i = item_ids.find(name);
+        if (i == item_ids.end()) throw std::runtime_error("unknown item \"" + name + "\"");
+        return i->second;
+    }
+
+    RoomId add_room(const std::string &name, std::string_view desc, std::string_view search = "") {
+        if (room_ids.count(name)) throw std::runtime_error("room " + name + " defined twice");
+        room_ids[name] = static_cast<RoomId>(rooms.size());
+        Room room;
+        room.name = name;
+        room.room_description = desc;
+        room.search_description = search;
+        rooms.push_back(std::move(room));
+        return static_cast<RoomId>(rooms.size() - 1);
+    }
+
+    RoomId room(const std::string &name) const {
+        auto i = room_ids.find(name);
+        if (i == room_ids.end()) throw std::runtime_error("unknown room " + name);
+        return i->second;
+    }
+
+    void add_room_exit(RoomId room, const std::string &direction, RoomId target) {
+        RoomId &exit = rooms[room].room_exits[static_cast<size_t>(parse_direction(direction))];
+        if (exit != NO_ROOM) {
+            throw std::runtime_error("room " + rooms[room].name + " has two " + direction +
+                                     " exits");
+        }
+        exit = target;
+    }
+
+    void add_door(RoomId room, const std::string &direction, const Door &door) {
+        rooms[room].doors[static_cast<size_t>(parse_direction(direction))] = door;
+    }
+
+    void add_chest(RoomId room, const Chest &chest) {
+        rooms[room].chest = static_cast<uint32_t>(chests.size());
+        chests.push_back(chest);
+    }
+
+    // Places an item on the floor, found by searching the room
+    void add_item(RoomId room, ItemId item) { rooms[room].floor_item = item; }
+
+    void add_npc(RoomId room, NPC npc) {
+        npc.room = room;
+        npcs.push_back(npc);
+    }
+
+    std::vector<char> compile() const;
+    void write(std::ostream &out) const;
+    static WorldBuilder parse(std::istream &in, const std::string &source);
+
+private:
+    std::map<std::string, ItemId> item_ids;
+    std::map<std::string, RoomId> room_ids;
+};
+
+// Lays the definitions out as a WorldHeader followed by the record tables, the symbol tables
+// and the text pool. Identical strings are stored once, and every item or key named by a door,
+// chest or NPC is resolved to its ItemId here, ignoring case.
+inline std::vector<char> WorldBuilder::compile() const {
+    if (start_room >= rooms.size()) throw std::runtime_error("world has no start room");
+
+    std::map<std::string, ItemId> item_symbols;
+    for (ItemId i = 0; i < items.size(); i++) {
+        auto [symbol, inserted] = item_symbols.try_emplace(to_lowercase(items[i].item_name), i);
+        if (!inserted) {
+            throw std::runtime_error("items \"" + items[symbol->second].item_name + "\" and \"" +
+                                     items[i].item_name + "\" differ only in case");
+        }
+    }
+    auto resolve = [&](const std::string &name) {
+        if (name.empty()) return NO_ITEM;
+        auto i = item_symbols.find(to_lowercase(name));
+        if (i == item_symbols.end()) throw std::runtime_error("unknown item \"" + name + "\"");
+        return i->second;
+    };
+    // NameIds follow the sorted symbol table, so an NPC's lowercased name is its symbol's name
+    std::map<std::string, NameId> npc_symbols;
+    for (const auto &npc : npcs) {
+        npc_symbols.try_emplace(to_lowercase(npc.name), NO_NAME);
+    }
+    NameId next_name = 0;
+    for (auto &symbol : npc_symbols) {
+        symbol.second = next_name++;
+    }
+
+    std::string text;
+    std::unordered_map<std::string, TextRef> interned;
+    auto intern = [&](const std::string &s) {
+        if (s.empty()) return TextRef{};
+        auto [i, inserted] = interned.try_emplace(s, TextRef{});
+        if (inserted) {
+            i->second =
+                TextRef{static_cast<uint32_t>(text.size()), static_cast<uint32_t>(s.size())};
+            text += s;
+        }
+        return i->second;
+    };
+
+    std::vector<RoomRecord> room_records;
+    std::vector<ExitRecord> exit_records;
+    std::vector<DoorRecord> door_records;
+    std::vector<ChestRecord> chest_records;
+    std::vector<ItemId> chest_keys;
+    std::vector<ItemRecord> item_records;
+    std::vector<NpcRecord> npc_records;
+
+    for (const auto &room : rooms) {
+        room_records.push_back(RoomRecord{intern(room.name), intern(room.room_description),
+                                          intern(room.search_description), room.chest,
+                                          room.floor_item});
+        for (size_t d = 0; d < DIRECTION_COUNT; d++) {
+            uint32_t door = NO_DOOR;
+            if (room.doors[d]) {
+                door = static_cast<uint32_t>(door_records.size());
+                door_records.push_back(DoorRecord{resolve(room.doors[d]->required_key)});
+            }
+            exit_records.push_back(ExitRecord{room.room_exits[d], door});
+        }
+    }
+    for (const auto &chest : chests) {
+        chest_records.push_back(ChestRecord{chest.contained_item,
+                                            static_cast<uint32_t>(chest_keys.size()),
+                                            static_cast<uint32_t>(chest.required_keys.size())});
+        for (const auto &key : chest.required_keys) {
+            chest_keys.push_back(resolve(key));
+        }
+    }
+    for (const auto &item : items) {
+        item_records.push_back(ItemRecord{intern(item.item_name), intern(item.item_description)});
+    }
+    for (const auto &npc : npcs) {
+        npc_records.push_back(NpcRecord{intern(npc.name), intern(npc.description),
+                                        intern(npc.dialogue),
+                                        intern(npc.post_receive_item_dialogue),
+                                        npc_symbols.at(to_lowercase(npc.name)),
+                                        resolve(npc.required_item), resolve(npc.death_item),
+                                        npc.health, npc.hostile, npc.drop_item,
+                                        npc.give_player_item, npc.room});
+    }
+    auto symbol_records = [&](const auto &symbols) {
+        std::vector<SymbolRecord> records;
+        for (const auto &[name, id] : symbols) {
+            records.push_back(SymbolRecord{intern(name), id});
+        }
+        return records;
+    };
+    std::vector<SymbolRecord> item_symbol_records = symbol_records(item_symbols);
+    std::vector<SymbolRecord> npc_symbol_records = symbol_records(npc_symbols);
+
+    WorldHeader header{};
+    std::memcpy(header.magic, WORLD_MAGIC, sizeof(WORLD_MAGIC));
+    header.version = WORLD_VERSION;
+    header.start_room = start_room;
+
+    size_t size = sizeof(WorldHeader);
+    auto place = [&](Section &section, size_t count, size_t record_size) {
+        size = (size + 7) & ~size_t{7};
+        section = Section{static_cast<uint32_t>(size), static_cast<uint32_t>(count)};
+        size += count * record_size;
+    };
+    place(header.rooms, room_records.size(), sizeof(RoomRecord));
+    place(header.exits, exit_records.size(), sizeof(ExitRecord));
+    place(header.doors, door_records.size(), sizeof(DoorRecord));
+    place(header.chests, chest_records.size(), sizeof(ChestRecord));
+    place(header.chest_keys, chest_keys.size(), sizeof(ItemId));
+    place(header.items, item_records.size(), sizeof(ItemRecord));
+    place(header.npcs, npc_records.size(), sizeof(NpcRecord));
+    place(header.item_symbols, item_symbol_records.size(), sizeof(SymbolRecord));
+    place(header.npc_symbols, npc_symbol_records.size(), sizeof(SymbolRecord));
+    place(header.text, text.size(), 1);
+    header.text_checksum = 2166136261u;
+    for (char c : text) {
+        header.text_checksum = (header.text_checksum ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    if (size > UINT32_MAX) throw std::runtime_error("world image is larger than 4GB");
+    header.size = static_cast<uint32_t>(size);
+
+    std::vector<char> image(size);
+    auto copy = [&](const Section &section, const auto &records) {
+        if (!records.empty()) {
+            std::memcpy(image.data() + section.offset, records.data(),
+                        records.size() * sizeof(records[0]));
+        }
+    };
+    std::memcpy(image.data(), &header, sizeof(header));
+    copy(header.rooms, room_records);
+    copy(header.exits, exit_records);
+    copy(header.doors, door_records);
+    copy(header.chests, chest_records);
+    copy(header.chest_keys, chest_keys);
+    copy(header.items, item_records);
+    copy(header.npcs, npc_records);
+    copy(header.item_symbols, item_symbol_records);
+    copy(header.npc_symbols, npc_symbol_records);
+    copy(header.text, text);
+    return image;
+}
+
+// World definition files are line based. Each line is a keyword followed by bare words or
+// double-quoted strings (with \n, \t, \", \\ and octal escapes); '#' starts a comment.
+//
+//   item "gold key" "The key shines bright..."
+//   room start                         starts a room, the lines below describe it
+//       description "You stand in the middle of the cell room...\n"
+//       search "..."
+//       exit north start_north
+//       door north "cell key"
+//       floor "rusted knife"
+//       chest "obsidian dagger" "blood-stained key"    contents, then any keys it needs
+//   npc prison_1_north                 starts an NPC standing in that room
+//       name "Masked Figure"
+//       description, health, hostile, requires, dialogue, death_item, after_gift, drops, gives
+//   start start
+
+inline std::string quote_world_string(std::string_view s) {
+    std::string result = "\"";
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += static_cast<char>(c);
+        } else if (c == '\n') {
+            result += "\\n";
+        } else if (c == '\t') {
+            result += "\\t";
+        } else if (c < 0x20 || c == 0x7f) {
+            char octal[5];
+            std::snprintf(octal, sizeof(octal), "\\%03o", c);
+            result += octal;
+        } else {
+            result += static_cast<char>(c);
+        }
+    }
+    return result + "\"";
+}
+
+inline void WorldBuilder::write(std::ostream &out) const {
+    auto item_name = [&](ItemId item) { return quote_world_string(items[item].item_name); };
+
+    out << "# Tenebrae world definition\n\n";
+    for (const auto &item : items) {
+        out << "item " << quote_world_string(item.item_name) << " "
+            << quote_world_string(item.item_description) << "\n";
+    }
+    for (const auto &room : rooms) {
+        out << "\nroom " << room.name << "\n";
+        out << "    description " << quote_world_string(room.room_description) << "\n";
+        if (!room.search_description.empty()) {
+            out << "    search " << quote_world_string(room.search_description) << "\n";
+        }
+        for (size_t d = 0; d < DIRECTION_COUNT; d++) {
+            if (room.room_exits[d] != NO_ROOM) {
+                out << "    exit " << DIRECTION_NAMES[d] << " " << rooms[room.room_exits[d]].name
+                    << "\n";
+            }
+        }
+        for (size_t d = 0; d < DIRECTION_COUNT; d++) {
+            if (room.doors[d]) {
+                out << "    door " << DIRECTION_NAMES[d] << " "
+                    << quote_world_string(room.doors[d]->required_key) << "\n";
+            }
+        }
+        if (room.floor_item != NO_ITEM) out << "    floor " << item_name(room.floor_item) << "\n";
+        if (room.chest != NO_CHEST) {
+            out << "    chest " << item_name(chests[room.chest].contained_item);
+            for (const auto &key : chests[room.chest].required_keys) {
+                out << " " << quote_world_string(key);
+            }
+            out << "\n";
+        }
+    }
+    for (const auto &npc : npcs) {
+        out << "\nnpc " << rooms[npc.room].name << "\n";
+        out << "    name " << quote_world_string(npc.name) << "\n";
+        out << "    description " << quote_world_string(npc.description) << "\n";
+        out << "    health " << npc.health << "\n";
+        if (npc.hostile) out << "    hostile\n";
+        if (!npc.required_item.empty()) {
+            out << "    requires " << quote_world_string(npc.required_item) << "\n";
+        }
+        if (!npc.dialogue.empty()) {
+            out << "    dialogue " << quote_world_string(npc.dialogue) << "\n";
+        }
+        if (!npc.death_item.empty()) {
+            out << "    death_item " << quote_world_string(npc.death_item) << "\n";
+        }
+        if (!npc.post_receive_item_dialogue.empty()) {
+            out << "    after_gift " << quote_world_string(npc.post_receive_item_dialogue) << "\n";
+        }
+        if (npc.drop_item != NO_ITEM) out << "    drops " << item_name(npc.drop_item) << "\n";
+        if (npc.give_player_item != NO_ITEM) {
+            out << "    gives " << item_name(npc.give_player_item) << "\n";
+        }
+    }
+    out << "\nstart " << rooms[start_room].name << "\n";
+}
+
+// Splits a line of a definition file into words and quoted strings (with \n, \t and octal
+// escapes), dropping a # comment
+inline std::vector<std::string> split_world_line(const std::string &line) {
+    std::vector<std::string> tokens;
+    for (size_t i = 0; i < line.size();) {
+        if (std::isspace(static_cast<unsigned char>(line[i]))) {
+            i++;
+        } else if (line[i] == '#') {
+            break;
+        } else if (line[i] == '"') {
+            std::string token;
+            for (i++; i < line.size() && line[i] != '"'; i++) {
+                if (line[i] != '\\' || i + 1 == line.size()) {
+                    token += line[i];
+                    continue;
+                }
+                char c = line[++i];
+                if (c == 'n') {
+                    token += '\n';
+                } else if (c == 't') {
+                    token += '\t';
+                } else if (c >= '0' && c <= '7') {
+                    int value = 0;
+                    for (int digits = 0;
+                         digits < 3 && i < line.size() && line[i] >= '0' && line[i] <= '7';
+                         digits++, i++) {
+                        value = value * 8 + (line[i] - '0');
+                    }
+                    i--;
+                    token += static_cast<char>(value);
+                } else {
+                    token += c;
+                }
+            }
+            if (i == line.size()) throw std::runtime_error("unterminated string");
+            tokens.push_back(token);
+            i++;
+        } else {
+            size_t end = i;
+            while (end < line.size() && !std::isspace(static_cast<unsigned char>(line[end])) &&
+                   line[end] != '"' && line[end] != '#') {
+                end++;
+            }
+            tokens.push_back(line.substr(i, end - i));
+            i = end;
+        }
+    }
+    return tokens;
+}
+
+inline WorldBuilder WorldBuilder::parse(std::istream &in, const std::string &source) {
+    WorldBuilder world;
+    size_t line_number = 0;
+    auto fail = [&](const std::string &message) {
+        throw std::runtime_error(source + ":" + std::to_string(line_number) + ": " + message);
+    };
+
+    struct PendingExit {
+        RoomId room;
+        std::string direction;
+        std::string target;
+        size_t line;
+    };
+    std::vector<PendingExit> exits;
+    std::vector<std::pair<std::string, size_t>> npc_rooms;
+    std::string start_name;
+    RoomId room = NO_ROOM;
+    NPC *npc = nullptr;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        line_number++;
+
+        std::vector<std::string> tokens;
+        try {
+            tokens = split_world_line(line);
+        } catch (const std::runtime_error &e) {
+            fail(e.what());
+        }
+        if (tokens.empty()) continue;
+
+        const std::string &keyword = tokens[0];
+        auto expect = [&](size_t count) {
+            if (tokens.size() != count + 1) {
+                fail(keyword + " takes " + std::to_string(count) + " argument(s)");
+            }
+        };
+        auto in_room = [&]() {
+            if (room == NO_ROOM) fail(keyword + " must follow a room");
+            return room;
+        };
+        auto in_npc = [&]() -> NPC & {
+            if (npc == nullptr) fail(keyword + " must follow an npc");
+            return *npc;
+        };
+        auto item = [&](const std::string &name) {
+            try {
+                return world.item(name);
+            } catch (const std::runtime_error &e) {
+                fail(e.what());
+            }
+            return NO_ITEM;
+        };
+
+        if (keyword == "item") {
+            expect(2);
+            try {
+                world.define_item(tokens[1], tokens[2]);
+            } catch (const std::runtime_error &e) {
+                fail(e.what());
+            }
+            room = NO_ROOM;
+            npc = nullptr;
+        } else if (keyword == "room") {
+            expect(1);
+            try {
+                room = world.add_room(tokens[1], "");
+            } catch (const std::runtime_error &e) {
+                fail(e.what());
+            }
+            npc = nullptr;
+        } else if (keyword == "npc") {
+            expect(1);
+            world.npcs.push_back(NPC("", ""));
+            npc = &world.npcs.back();
+            npc_rooms.emplace_back(tokens[1], line_number);
+            room = NO_ROOM;
+        } else if (keyword == "start") {
+            expect(1);
+            start_name = tokens[1];
+        } else if (keyword == "description" && npc != nullptr) {
+            expect(1);
+            npc->description = tokens[1];
+        } else if (keyword == "description") {
+            expect(1);
+            world.rooms[in_room()].room_description = tokens[1];
+        } else if (keyword == "search") {
+            expect(1);
+            world.rooms[in_room()].search_description = tokens[1];
+        } else if (keyword == "exit") {
+            expect(2);
+            exits.push_back(PendingExit{in_room(), tokens[1], tokens[2], line_number});
+        } else if (keyword == "door") {
+            expect(2);
+            try {
+                world.add_door(in_room(), tokens[1], Door(tokens[2]));
+            } catch (const std::runtime_error &e) {
+                fail(e.what());
+            }
+        } else if (keyword == "floor") {
+            expect(1);
+            world.add_item(in_room(), item(tokens[1]));
+        } else if (keyword == "chest") {
+            if (tokens.size() < 2) fail("chest needs the item it contains");
+            RoomId chest_room = in_room();
+            world.add_chest(chest_room, Chest(item(tokens[1]),
+                                              std::vector<std::string>(tokens.begin() + 2,
+                                                                       tokens.end())));
+        } else if (keyword == "name") {
+            expect(1);
+            in_npc().name = tokens[1];
+        } else if (keyword == "health") {
+            expect(1);
+            try {
+                in_npc().health = std::stoi(tokens[1]);
+            } catch (const std::exception &) {
+                fail("health must be a number");
+            }
+        } else if (keyword == "hostile") {
+            expect(0);
+            in_npc().hostile = true;
+        } else if (keyword == "requires") {
+            expect(1);
+            in_npc().required_item = tokens[1];
+        } else if (keyword == "dialogue") {
+            expect(1);
+            in_npc().dialogue = tokens[1];
+        } else if (keyword == "death_item") {
+            expect(1);
+            in_npc().death_item = tokens[1];
+        } else if (keyword == "after_gift") {
+            expect(1);
+            in_npc().post_receive_item_dialogue = tokens[1];
+        } else if (keyword == "drops") {
+            expect(1);
+            in_npc().drop_item = item(tokens[1]);
+        } else if (keyword == "gives") {
+            expect(1);
+            in_npc().give_player_item = item(tokens[1]);
+        } else {
+            fail("unknown keyword " + keyword);
+        }
+    }
+
+    // Rooms can be referred to before they are defined
+    for (const auto &exit : exits) {
+        line_number = exit.line;
+        try {
+            world.add_room_exit(exit.room, exit.direction, world.room(exit.target));
+        } catch (const std::runtime_error &e) {
+            fail(e.what());
+        }
+    }
+    for (size_t i = 0; i < npc_rooms.size(); i++) {
+        line_number = npc_rooms[i].second;
+        try {
+            world.npcs[i].room = world.room(npc_rooms[i].first);
+        } catch (const std::runtime_error &e) {
+            fail(e.what());
+        }
+    }
+    if (start_name.empty()) throw std::runtime_error(source + ": no start room");
+    world.start_room = world.room(start_name);
+    return world;
+}
+
+// Compiled images are mapped as they are; definition files are compiled in memory first
+inline WorldTemplate load_world(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) throw std::runtime_error("Could not open world " + path);
+    char magic[sizeof(WORLD_MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+    if (WorldTemplate::is_image(magic, static_cast<size_t>(file.gcount()))) {
+        return WorldTemplate::map_file(path);
+    }
+    file.clear();
+    file.seekg(0);
+    WorldBuilder world = WorldBuilder::parse(file, path);
+    try {
+        return WorldTemplate(world.compile());
+    } catch (const std::runtime_error &e) {
+        throw std::runtime_error(path + ": " + e.what());
+    }
+}
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "world.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+// Finds what makes a world unplayable in places without making its image invalid: rooms that
+// cannot be reached, exits with no way back, doors and chests whose keys can never be had, and
+// items NPCs ask for that are nowhere in the world. Each table is walked a constant number of
+// times, so a world of a million rooms is checked in well under a second, cheap enough to run on
+// every load.
+//
+// Progress is played forward from the start room, granting every item as soon as it can be had
+// and opening every door as soon as its key is found. Giving an item away is assumed not to use
+// it up, so only worlds that fail even then are reported.
+
+namespace detail {
+
+// Values grouped by key, laid out as one array with an offset per key (compressed rows)
+class GroupedIds {
+public:
+    GroupedIds(size_t keys, const std::vector<std::pair<uint32_t, uint32_t>> &pairs)
+        : start(keys + 1, 0), values(pairs.size()) {
+        for (const auto &pair : pairs) start[pair.first + 1]++;
+        for (size_t i = 0; i < keys; i++) start[i + 1] += start[i];
+        std::vector<uint32_t> next(start.begin(), start.end() - 1);
+        for (const auto &pair : pairs) values[next[pair.first]++] = pair.second;
+    }
+
+    std::span<const uint32_t> operator[](uint32_t key) const {
+        return std::span<const uint32_t>(values).subspan(start[key], start[key + 1] - start[key]);
+    }
+
+private:
+    std::vector<uint32_t> start;
+    std::vector<uint32_t> values;
+};
+
+} // namespace detail
+
+inline std::vector<std::string> validate_world(const WorldTemplate &world) {
+    auto rooms = world.rooms();
+    auto exits = world.exits();
+    auto doors = world.doors();
+    auto chests = world.chests();
+    auto npcs = world.npcs();
+    const size_t item_count = world.items().size();
+    std::vector<std::string> problems;
+
+    auto room_name = [&](RoomId room) { return std::string(world.text(rooms[room].name)); };
+    auto item_name = [&](ItemId item) { return std::string(world.item_name(item)); };
+    auto exit_name = [&](size_t exit) {
+        return std::string(DIRECTION_NAMES[exit % DIRECTION_COUNT]) + " exit of " +
+               room_name(static_cast<RoomId>(exit / DIRECTION_COUNT));
+    };
+
+    // Where each item can come from, and what is waiting for it
+    std::vector<uint8_t> placed(item_count, false);
+    std::vector<RoomId> chest_room(chests.size(), NO_ROOM);
+    std::vector<std::pair<uint32_t, uint32_t>> door_waits, chest_waits, npc_waits, room_npcs;
+    for (RoomId room = 0; room < rooms.size(); room++) {
+        if (rooms[room].floor_item != NO_ITEM) placed[rooms[room].floor_item] = true;
+        if (rooms[room].chest != NO_CHEST) chest_room[rooms[room].chest] = room;
+    }
+    for (uint32_t chest = 0; chest < chests.size(); chest++) {
+        if (chests[chest].contained_item != NO_ITEM) placed[chests[chest].contained_item] = true;
+        for (ItemId key : world.keys(chests[chest])) chest_waits.emplace_back(key, chest);
+    }
+    for (uint32_t npc = 0; npc < npcs.size(); npc++) {
+        if (npcs[npc].drop_item != NO_ITEM) placed[npcs[npc].drop_item] = true;
+        if (npcs[npc].give_player_item != NO_ITEM) placed[npcs[npc].give_player_item] = true;
+        for (ItemId item : {npcs[npc].required_item, npcs[npc].death_item}) {
+            if (item != NO_ITEM) npc_waits.emplace_back(item, npc);
+        }
+        room_npcs.emplace_back(npcs[npc].room, npc);
+    }
+    for (size_t exit = 0; exit < exits.size(); exit++) {
+        ItemId key = exits[exit].door == NO_DOOR ? NO_ITEM : doors[exits[exit].door].required_key;
+        if (exits[exit].target != NO_ROOM && key != NO_ITEM) {
+            door_waits.emplace_back(key, static_cast<uint32_t>(exit));
+        }
+    }
+    detail::GroupedIds waiting_doors(item_count, door_waits);
+    detail::GroupedIds waiting_chests(item_count, chest_waits);
+    detail::GroupedIds waiting_npcs(item_count, npc_waits);
+    detail::GroupedIds npcs_in_room(rooms.size(), room_npcs);
+
+    // Play forward: rooms and items are each queued once, when first reached or had
+    std::vector<uint8_t> reached(rooms.size(), false);
+    std::vector<uint8_t> have(item_count, false);
+    std::vector<uint32_t> keys_missing(chests.size());
+    for (uint32_t chest = 0; chest < chests.size(); chest++) {
+        keys_missing[chest] = chests[chest].key_count;
+    }
+    std::vector<RoomId> room_queue;
+    std::vector<ItemId> item_queue;
+    auto enter = [&](RoomId room) {
+        if (room == NO_ROOM || reached[room]) return;
+        reached[room] = true;
+        room_queue.push_back(room);
+    };
+    auto grant = [&](ItemId item) {
+        if (item == NO_ITEM || have[item]) return;
+        have[item] = true;
+        item_queue.push_back(item);
+    };
+    const ItemId dagger = world.rule_items().obsidian_dagger;
+    auto meet = [&](uint32_t npc) {
+        const NpcRecord &record = npcs[npc];
+        if (!reached[record.room]) return;
+        if (record.required_item != NO_ITEM && have[record.required_item]) {
+            grant(record.give_player_item);
+        }
+        if ((record.death_item != NO_ITEM && have[record.death_item]) ||
+            (dagger != NO_ITEM && have[dagger])) {
+            grant(record.drop_item);
+        }
+    };
+
+    enter(world.start_room());
+    size_t next_room = 0, next_item = 0;
+    while (next_room < room_queue.size() || next_item < item_queue.size()) {
+        if (next_room < room_queue.size()) {
+            RoomId room = room_queue[next_room++];
+            grant(rooms[room].floor_item);
+            uint32_t chest = rooms[room].chest;
+            if (chest != NO_CHEST && keys_missing[chest] == 0) grant(chests[chest].contained_item);
+            for (uint32_t npc : npcs_in_room[room]) meet(npc);
+            for (const ExitRecord &exit : world.exits(room)) {
+                ItemId key = exit.door == NO_DOOR ? NO_ITEM : doors[exit.door].required_key;
+                if (key == NO_ITEM || have[key]) enter(exit.target);
+            }
+            continue;
+        }
+        ItemId item = item_queue[next_item++];
+        for (uint32_t exit : waiting_doors[item]) {
+            if (reached[exit / DIRECTION_COUNT]) enter(exits[exit].target);
+        }
+        for (uint32_t chest : waiting_chests[item]) {
+            if (--keys_missing[chest] == 0 && chest_room[chest] != NO_ROOM &&
+                reached[chest_room[chest]]) {
+                grant(chests[chest].contained_item);
+            }
+        }
+        for (uint32_t npc : waiting_npcs[item]) meet(npc);
+        if (item == dagger) {
+            for (uint32_t npc = 0; npc < npcs.size(); npc++) meet(npc);
+        }
+    }
+
+    // Rooms the map does not connect at all, as opposed to rooms only locked away
+    std::vector<uint8_t> connected(rooms.size(), false);
+    std::vector<RoomId> queue{world.start_room()};
+    connected[world.start_room()] = true;
+    for (size_t head = 0; head < queue.size(); head++) {
+        for (const ExitRecord &exit : world.exits(queue[head])) {
+            if (exit.target != NO_ROOM && !connected[exit.target]) {
+                connected[exit.target] = true;
+                queue.push_back(exit.target);
+            }
+        }
+    }
+    // One line for each kind, naming the first few, since a single locked door can shut out
+    // thousands of rooms
+    auto report_rooms = [&](const std::string &problem, auto &&matches) {
+        constexpr size_t NAMED = 5;
+        size_t count = 0;
+        std::string names;
+        for (RoomId room = 0; room < rooms.size(); room++) {
+            if (!matches(room)) continue;
+            if (count < NAMED) names += (count ? ", " : "") + room_name(room);
+            count++;
+        }
+        if (count == 0) return;
+        problems.push_back(std::to_string(count) + (count == 1 ? " room " : " rooms ") + problem +
+                           ": " + names + (count > NAMED ? ", ..." : ""));
+    };
+    report_rooms("cannot be reached from the start",
+                 [&](RoomId room) { return !connected[room]; });
+    report_rooms("can only be reached through doors that never open",
+                 [&](RoomId room) { return connected[room] && !reached[room]; });
+
+    // With one exit slot per direction, finding the way back is four loads
+    for (size_t exit = 0; exit < exits.size(); exit++) {
+        RoomId target = exits[exit].target;
+        if (target == NO_ROOM) continue;
+        RoomId room = static_cast<RoomId>(exit / DIRECTION_COUNT);
+        bool way_back = false;
+        for (const ExitRecord &back : world.exits(target)) way_back |= back.target == room;
+        if (!way_back) {
+            problems.push_back("the " + exit_name(exit) + " leads to " + room_name(target) +
+                               ", which has no way back");
+        }
+    }
+
+    auto unobtainable = [&](ItemId key) {
+        return placed[key] ? ", which is only found behind doors that never open"
+                           : ", which is nowhere in the world";
+    };
+    for (size_t exit = 0; exit < exits.size(); exit++) {
+        uint32_t door = exits[exit].door;
+        if (exits[exit].target == NO_ROOM || door == NO_DOOR) continue;
+        ItemId key = doors[door].required_key;
+        if (key != NO_ITEM && !have[key] && reached[exit / DIRECTION_COUNT]) {
+            problems.push_back("the door on the " + exit_name(exit) + " needs the " +
+                               item_name(key) + unobtainable(key));
+        }
+    }
+    for (uint32_t chest = 0; chest < chests.size(); chest++) {
+        if (chest_room[chest] == NO_ROOM || !reached[chest_room[chest]]) continue;
+        for (ItemId key : world.keys(chests[chest])) {
+            if (have[key]) continue;
+            problems.push_back("the chest in " + room_name(chest_room[chest]) + " needs the " +
+                               item_name(key) + unobtainable(key));
+        }
+    }
+    for (const NpcRecord &npc : npcs) {
+        if (npc.required_item != NO_ITEM && !placed[npc.required_item]) {
+            problems.push_back(std::string(world.text(npc.name)) + " in " + room_name(npc.room) +
+                               " asks for the " + item_name(npc.required_item) +
+                               ", which is nowhere in the world");
+        }
+    }
+
+    ItemId goal = world.rule_items().orbis_dei;
+    if (goal == NO_ITEM) {
+        problems.push_back("the world has no ORBIS DEI, so it cannot be won");
+    } else if (!have[goal]) {
+        problems.push_back("the ORBIS DEI can never be obtained, so the world cannot be won");
+    }
+    return problems;
+}